@@ -2,20 +2,36 @@
 ; iNES header, reset/NMI/IRQ handlers, vector table
 
 .import _main
+.ifdef TRACE
+.import trace_nmi_ev
+; NMI trace events (must match tetris.h)
+EV_NMI_IN  = $0A
+EV_NMI_OUT = $0B
+.endif
 .import __DATA_LOAD__, __DATA_RUN__, __DATA_SIZE__
 .importzp sp
 
 .export __STARTUP__: absolute = 1
 .exportzp _nmi_flag
-.exportzp _vbuf_len
+.exportzp _vbuf_len, _vbuf_budget, _region
+
+.ifdef UNROM
+.import _bank_set
+.endif
 
 .segment "HEADER"
 ; iNES header (16 bytes)
 .byte "NES", $1A       ; Magic number
+.ifdef UNROM
+.byte $04              ; 4 x 16KB PRG-ROM (banks 0-2 switchable, 3 fixed)
+.byte $00              ; CHR-RAM, loaded from chr_data at reset
+.byte $21              ; Mapper 2 (UNROM), vertical mirroring
+.else
 .byte $01              ; 1 x 16KB PRG-ROM
 .byte $01              ; 1 x 8KB CHR-ROM
 .byte $01              ; Mapper 0 (NROM), vertical mirroring
-.byte $00              ; Mapper 0 upper nybble
+.endif
+.byte $00              ; Mapper upper nybble
 .byte $00,$00,$00,$00  ; Unused
 .byte $00,$00,$00,$00  ; Unused
 
@@ -28,18 +44,46 @@ ppu_mask_var:   .res 1  ; Shadow of PPU_MASK ($2001)
 scroll_x:      .res 1
 scroll_y:      .res 1
 pad_state:     .res 2   ; Controller state (2 pads)
-_vbuf_len:     .res 1   ; VRAM buffer entry count (0..42)
+_vbuf_len:     .res 1   ; VRAM buffer entry count (0.._vbuf_budget)
+_vbuf_budget:  .res 1   ; Entries the NMI can drain per frame in this region
+_region:       .res 1   ; TV region detected at reset (REGION_*)
 
 .exportzp ppu_ctrl_var, ppu_mask_var, nmi_ready
 .exportzp scroll_x, scroll_y, pad_state
 
+; TV regions (must match neslib.h)
+REGION_NTSC  = 0
+REGION_PAL   = 1
+REGION_DENDY = 2
+
+; VRAM buffer entries the NMI drains per frame (must match neslib.h).
+; NTSC and Dendy have a 20-line vblank; EXT_VBLANK keeps rendering off
+; through the top EXT_VBLANK_LINES scanlines (plus the pre-render line),
+; which buys 18 more entries. PAL's 70-line vblank drains the whole
+; buffer, VBUF_CAP entries (3 * VBUF_CAP must fit an 8-bit index).
+.ifdef EXT_VBLANK
+VBUF_NTSC = 60
+EXT_VBLANK_LINES = 8
+; The timed NMI path has no room for trace markers (the Makefile refuses too)
+.assert .not .defined(TRACE), error, "TRACE cannot be combined with EXT_VBLANK"
+.else
+VBUF_NTSC = 42
+.endif
+VBUF_PAL = 84
+VBUF_CAP = VBUF_PAL
+.ifdef TRACE
+.assert VBUF_CAP < $80, error, "EV_VBUF trace markers carry vbuf_len in 7 bits"
+.endif
+
 .segment "OAM"
 oam_buf:    .res 256     ; Sprite OAM buffer at $0200
 
 .segment "BSS"
+; First in BSS so it starts page-aligned at $0300 and the drain never
+; crosses a page
+_vram_buf:  .res VBUF_CAP * 3 ; VRAM update buffer: 3 bytes per entry (addr_hi, addr_lo, tile)
 pal_buf:    .res 32      ; Palette buffer
 pal_dirty:  .res 1       ; Non-zero = upload palette in NMI
-_vram_buf:  .res 128     ; VRAM update buffer: 42 entries × 3 bytes (addr_hi, addr_lo, tile) + padding
 _oam_buf = oam_buf       ; C-visible alias
 
 .export pal_buf, pal_dirty, oam_buf
@@ -120,6 +164,68 @@ reset:
     lda #$00
     sta _vbuf_len
 
+.ifdef UNROM
+    ; Copy the font from its PRG bank to CHR-RAM. sp is free as a pointer
+    ; until the C stack is set up below.
+    lda #<.bank(chr_data)
+    jsr _bank_set
+    lda #<chr_data
+    sta sp
+    lda #>chr_data
+    sta sp+1
+    lda #$00
+    sta $2006
+    sta $2006
+    ldx #$20             ; 32 pages = 8KB
+    ldy #$00
+@copy_chr:
+    lda (sp),y
+    sta $2007
+    iny
+    bne @copy_chr
+    inc sp+1
+    dex
+    bne @copy_chr
+.endif
+
+    ; ── Region detection ──
+    ; Count 11-cycle loop iterations between two NMIs (nmi_ready is still
+    ; 0, so the handler only sets _nmi_flag): NTSC 29780 cycles = $A9x
+    ; iterations, PAL 33247 = $BCx, Dendy 35464 = $C9x. The high byte
+    ; minus 10 is the region.
+    lda #$80
+    sta $2000            ; Enable NMI
+    lda #$00
+    sta _nmi_flag
+@region_sync:
+    lda _nmi_flag
+    beq @region_sync
+    ldx #$00
+    ldy #$00
+    stx _nmi_flag
+@region_count:
+    inx
+    bne @region_same
+    iny
+@region_same:
+    lda _nmi_flag
+    beq @region_count
+    .assert >@region_count = >*, error, "region count loop crosses a page"
+    lda #$00
+    sta $2000            ; NMI off again until main() turns rendering on
+    sta _nmi_flag
+    tya
+    sec
+    sbc #10
+    cmp #REGION_DENDY + 1
+    bcc @region_ok
+    lda #REGION_NTSC     ; Unknown timing: assume NTSC
+@region_ok:
+    sta _region
+    tax
+    lda vbuf_budgets,x
+    sta _vbuf_budget
+
     ; Initialize cc65 C software stack pointer (grows down from top of RAM)
     lda #$00
     sta sp
@@ -133,8 +239,22 @@ reset:
     ; Jump to C main()
     jmp _main
 
+.segment "RODATA"
+; Per-frame VRAM entry budget, indexed by region (NTSC, PAL, Dendy)
+vbuf_budgets:
+    .byte VBUF_NTSC, VBUF_PAL, VBUF_NTSC
+
 ; ────────────────────────────────────────────────
 ; NMI handler (called every vblank)
+;
+; With EXT_VBLANK, NTSC and Dendy take a separate path in which every
+; branch takes a fixed number of cycles (palette upload or an equal wait,
+; drain plus padding up to VBUF_NTSC entries), so the PPU_MASK write at
+; the end lands in the hblank at the end of scanline EXT_VBLANK_LINES-1.
+; Cycle counts assume the timed loops do not cross a page; the .asserts
+; below check that. Scroll is fixed at (0,0) in this mode; only the
+; nametable select in ppu_ctrl_var is applied. PAL's vblank outlasts the
+; whole drain, so it always takes the standard path.
 ; ────────────────────────────────────────────────
 .segment "CODE"
 
@@ -145,6 +265,11 @@ nmi:
     tya
     pha
 
+.ifdef TRACE
+    lda #EV_NMI_IN
+    jsr trace_nmi_ev
+.endif
+
     ; Set NMI flag
     lda #$01
     sta _nmi_flag
@@ -153,6 +278,12 @@ nmi:
     lda nmi_ready
     beq @nmi_done
 
+.ifdef EXT_VBLANK
+    lda _region
+    cmp #REGION_PAL
+    bne @ext_nmi
+.endif
+
     ; OAM DMA
     lda #$00
     sta $2003            ; OAM address = 0
@@ -217,7 +348,151 @@ nmi:
     lda ppu_mask_var
     sta $2001
 
+.ifdef EXT_VBLANK
+    jmp @nmi_done
+
+    ; ── Extended vblank path (NTSC, Dendy) ──
+@ext_nmi:
+    ; Forced blank until the timed PPU_MASK write below
+    lda #$00
+    sta $2001
+
+    ; OAM DMA
+    lda #$00
+    sta $2003
+    lda #>oam_buf
+    sta $4014
+
+    ; Upload palette if dirty
+    lda pal_dirty
+    beq @ext_pal_wait
+
+    lda #$3F
+    sta $2006
+    lda #$00
+    sta $2006
+
+    ldx #$00
+@ext_pal_loop:
+    lda pal_buf,x
+    sta $2007
+    inx
+    cpx #$20
+    bne @ext_pal_loop
+    .assert >@ext_pal_loop = >*, error, "NMI palette loop crosses a page"
+
+    lda #$00
+    sta pal_dirty
+    jmp @ext_pal_done    ; 508 cycles from lda pal_dirty
+@ext_pal_wait:
+    ; Burn the same 508 cycles when there is no upload
+    ldx #99
+@ext_pal_wait_loop:
+    dex
+    bne @ext_pal_wait_loop
+    .assert >@ext_pal_wait_loop = >*, error, "NMI palette wait loop crosses a page"
+    bit $00
+    nop
+@ext_pal_done:
+
+    ; ── VRAM buffer drain ──
+    ldx _vbuf_len
+    beq @ext_no_vbuf
+
+    ldy #$00
+@ext_vbuf_loop:
+    lda _vram_buf,y        ; addr_hi
+    sta $2006
+    iny
+    lda _vram_buf,y        ; addr_lo
+    sta $2006
+    iny
+    lda _vram_buf,y        ; tile
+    sta $2007
+    iny
+    dex
+    bne @ext_vbuf_loop
+    .assert >@ext_vbuf_loop = >*, error, "NMI drain loop crosses a page"
+    .assert >_vram_buf = >(_vram_buf + VBUF_NTSC * 3 - 1), error, "vram_buf crosses a page"
+    jmp @ext_drained     ; 35*N + 9 cycles from ldx _vbuf_len
+@ext_no_vbuf:
+    bit $00              ; N = 0: 9 cycles
+@ext_drained:
+
+    ; Pad the unused entries at 35 cycles each
+    lda #VBUF_NTSC
+    sec
+    sbc _vbuf_len
+    tax
+    beq @ext_no_pad
+@ext_pad_loop:
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    dex
+    bne @ext_pad_loop
+    .assert >@ext_pad_loop = >*, error, "NMI pad loop crosses a page"
+    nop
+    jmp @ext_padded      ; 35*P + 15 cycles from lda #VBUF_NTSC
+@ext_no_pad:
+    bit $00              ; P = 0: 15 cycles
+@ext_padded:
+
+    ; Clear buffer
+    lda #$00
+    sta _vbuf_len
+
+    ; Point the PPU at tile row 1 of the selected nametable (v = $2020),
+    ; as rendering starts at scanline EXT_VBLANK_LINES
+    bit $2002            ; reset the $2005/$2006 latch
+    lda #$00
+    sta $2005            ; fine X = 0
+    sta $2005
+    lda ppu_ctrl_var
+    and #$03
+    asl
+    asl
+    ora #$20
+    sta $2006
+    lda #$20
+    sta $2006
+    lda ppu_ctrl_var
+    sta $2000
+
+    ; Wait out the rest of the blank lines. From the first instruction of
+    ; the handler: 1148 fixed cycles + 35 * VBUF_NTSC + this delay puts the
+    ; PPU_MASK write ~3270 cycles after the NMI, at dot ~289 of scanline 7.
+    .assert VBUF_NTSC = 60, error, "retune the EXT_VBLANK delay for VBUF_NTSC"
+    ldx #3
+@ext_delay:
+    dex
+    bne @ext_delay
+    .assert >@ext_delay = >*, error, "NMI delay loop crosses a page"
+    nop
+    nop
+    nop                  ; 22 cycles
+
+    lda ppu_mask_var
+    sta $2001
+.endif
+
 @nmi_done:
+.ifdef TRACE
+    lda #EV_NMI_OUT
+    jsr trace_nmi_ev
+.endif
     pla
     tay
     pla
@@ -240,7 +515,8 @@ irq:
 .word irq       ; $FFFE - IRQ vector
 
 ; ────────────────────────────────────────────────
-; CHR-ROM data
+; CHR data: CHR-ROM on NROM, a PRG bank copied to CHR-RAM on UNROM
 ; ────────────────────────────────────────────────
 .segment "CHARS"
+chr_data:
 .incbin "../chr/ascii.chr"
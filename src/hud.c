@@ -0,0 +1,76 @@
+/* hud.c - Retained-mode HUD: numeric widgets diffed against the screen
+ *
+ * Each widget shows a run of BCD digits from the player's state. The HUD
+ * keeps a shadow copy of every digit tile on screen and queues only the
+ * tiles that changed, so a score update that touches one digit costs one
+ * VRAM entry and a widget that did not change costs none. Adding a widget
+ * is a BCD field in player_t plus a row in widgets[] (and HUD_DIGITS).
+ */
+
+#include <stddef.h>
+#include "neslib.h"
+#include "tetris.h"
+
+/* A widget: digits BCD digits (most significant first) read from the
+ * player_t bytes at offset src, drawn left to right at (dx, dy) from the
+ * player's HUD origin.
+ */
+typedef struct {
+    unsigned char src;
+    unsigned char digits;
+    unsigned char dx;
+    unsigned char dy;
+} hud_widget_t;
+
+static const hud_widget_t widgets[] = {
+    { offsetof(player_t, score),     6, SCORE_DX, SCORE_DY + 1 },
+    { offsetof(player_t, lines),     4, LINES_DX, LINES_DY + 1 },
+    { offsetof(player_t, level_bcd), 2, LEVEL_DX, LEVEL_DY + 1 },
+};
+#define NUM_WIDGETS (sizeof(widgets) / sizeof(widgets[0]))
+
+/* ── Forget what is on screen: every digit is redrawn on the next update ── */
+void hud_reset(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < HUD_DIGITS; ++i)
+        pl->hud_shadow[i] = 0xFF;
+    pl->hud_dirty = 1;
+}
+
+/* ── Queue the active player's changed HUD digits ──
+ * Does nothing unless a value changed since the last update. If the VRAM
+ * buffer fills up, the remaining digits stay dirty for the next frame.
+ */
+void hud_update(void)
+{
+    const hud_widget_t *w;
+    const unsigned char *bcd;
+    unsigned char d, s, tile;
+    unsigned int adr;
+
+    if (!pl->hud_dirty)
+        return;
+
+    s = 0;
+    for (w = widgets; w < widgets + NUM_WIDGETS; ++w) {
+        bcd = (const unsigned char *)pl + w->src;
+        adr = GAME_NTADR(pl->hud_x + w->dx, pl->hud_y + w->dy);
+        for (d = 0; d < w->digits; ++d, ++s, ++adr) {
+            if (d & 1) {
+                tile = CHR('0') + (*bcd & 0x0F);
+                ++bcd;
+            } else {
+                tile = CHR('0') + (*bcd >> 4);
+            }
+            if (tile != pl->hud_shadow[s]) {
+                if (!vbuf_room())
+                    return;
+                vbuf_put(adr, tile);
+                pl->hud_shadow[s] = tile;
+            }
+        }
+    }
+    pl->hud_dirty = 0;
+}
@@ -0,0 +1,263 @@
+; kernels.s - Hand-written hot-path kernels for the game core
+; Assembly versions of check_collision, lock_piece and update_sprites
+; (C versions in tetris.c / render.c). Built when ASM_KERNELS is defined.
+
+.importzp _pl, _playfield, _vbuf_len
+.importzp _col_piece, _col_rot, _col_x, _col_y
+.import _piece_x, _piece_y, _piece_pal
+.import _vram_buf, _oam_buf
+
+.export _check_collision, _lock_piece, _update_sprites
+
+; Playfield geometry (must match tetris.h)
+.ifndef PF_W
+PF_W = 10
+.endif
+.ifndef PF_H
+PF_H = 20
+.endif
+.ifndef PF_Y
+PF_Y = 2
+.endif
+
+; Tile constants (must match neslib.h)
+TILE_BLOCK = $61
+
+; player_t field offsets (must match the head of player_t in tetris.h)
+PL_CUR_PIECE = 0
+PL_CUR_ROT   = 1
+PL_CUR_X     = 2
+PL_CUR_Y     = 3
+PL_PF_X      = 4
+PL_OAM       = 5
+
+.segment "ZEROPAGE"
+k_end:     .res 1   ; piece table index one past the last block
+k_bx:      .res 1   ; block column
+k_by:      .res 1   ; block row
+k_x:       .res 1   ; piece origin (cur_x / pf_x based, per kernel)
+k_y:       .res 1
+k_val:     .res 1   ; cell value / sprite palette
+k_oam:     .res 1   ; OAM write offset
+
+.segment "RODATA"
+
+; Row start offsets into playfield[]: r * PF_W
+row_ofs:
+.repeat PF_H, r
+    .byte r * PF_W
+.endrepeat
+
+; Game nametable (B) address of column 0 (before pf_x) of each playfield row
+nt_row_lo:
+.repeat PF_H, r
+    .byte <($2400 + (r + PF_Y) * 32)
+.endrepeat
+nt_row_hi:
+.repeat PF_H, r
+    .byte >($2400 + (r + PF_Y) * 32)
+.endrepeat
+
+.segment "CODE"
+
+; ────────────────────────────────────────────────
+; Common prologue: X = piece*16 + rot*4, k_end = X + 4
+; A = piece on entry, rot in k_val
+; ────────────────────────────────────────────────
+piece_index:
+    asl
+    asl
+    ora k_val
+    asl
+    asl
+    tax
+    clc
+    adc #4
+    sta k_end
+    rts
+
+; ────────────────────────────────────────────────
+; unsigned char __fastcall__ check_collision(void)
+; Args in zero page: col_piece, col_rot, col_x, col_y
+; Returns 1 if any block is off the board or on a filled cell
+; ────────────────────────────────────────────────
+_check_collision:
+    lda _col_rot
+    sta k_val
+    lda _col_piece
+    jsr piece_index
+@loop:
+    lda _piece_x,x
+    clc
+    adc _col_x
+    cmp #PF_W
+    bcs @hit             ; past a wall (negative columns wrap to >= 128)
+    sta k_bx
+    lda _piece_y,x
+    clc
+    adc _col_y
+    bmi @next            ; above the playfield is OK (spawning)
+    cmp #PF_H
+    bcs @hit             ; below the floor
+    tay
+    lda row_ofs,y
+    clc
+    adc k_bx
+    tay
+    lda (_playfield),y
+    bne @hit
+@next:
+    inx
+    cpx k_end
+    bne @loop
+    lda #$00
+    tax
+    rts
+@hit:
+    ldx #$00
+    lda #$01
+    rts
+
+; ────────────────────────────────────────────────
+; void __fastcall__ lock_piece(void)
+; Writes the active piece into playfield[] and queues its 4 tiles
+; ────────────────────────────────────────────────
+_lock_piece:
+    ldy #PL_CUR_X
+    lda (_pl),y
+    sta k_x
+    ldy #PL_CUR_Y
+    lda (_pl),y
+    sta k_y
+    ldy #PL_CUR_ROT
+    lda (_pl),y
+    sta k_val
+    ldy #PL_CUR_PIECE
+    lda (_pl),y
+    jsr piece_index
+    ldy #PL_CUR_PIECE
+    lda (_pl),y
+    clc
+    adc #$01             ; nonzero = filled
+    sta k_val
+@loop:
+    lda _piece_y,x
+    clc
+    adc k_y
+    cmp #PF_H
+    bcs @next            ; above or below the board
+    sta k_by
+    lda _piece_x,x
+    clc
+    adc k_x
+    cmp #PF_W
+    bcs @next
+    sta k_bx
+
+    ; playfield[by * PF_W + bx] = cur_piece + 1
+    ldy k_by
+    lda row_ofs,y
+    clc
+    adc k_bx
+    tay
+    lda k_val
+    sta (_playfield),y
+
+    ; Queue VRAM update: addr_hi, addr_lo, tile
+    ldy #PL_PF_X
+    lda (_pl),y
+    clc
+    adc k_bx
+    sta k_bx             ; nametable column
+    lda _vbuf_len
+    asl
+    adc _vbuf_len        ; * 3 (carry clear: vbuf_len < 86)
+    tay
+    stx k_oam            ; save piece table index
+    ldx k_by
+    lda nt_row_hi,x
+    sta _vram_buf,y
+    lda nt_row_lo,x
+    ora k_bx             ; row address has bits 0-4 clear
+    sta _vram_buf+1,y
+    lda #TILE_BLOCK
+    sta _vram_buf+2,y
+    ldx k_oam
+    inc _vbuf_len
+@next:
+    inx
+    cpx k_end
+    bne @loop
+    rts
+
+; ────────────────────────────────────────────────
+; void __fastcall__ update_sprites(void)
+; Updates the active player's 4 OAM sprites for its falling piece
+; ────────────────────────────────────────────────
+_update_sprites:
+    ldy #PL_PF_X
+    lda (_pl),y
+    sta k_x
+    ldy #PL_CUR_Y
+    lda (_pl),y
+    sta k_y
+    ldy #PL_OAM
+    lda (_pl),y
+    sta k_oam
+    ldy #PL_CUR_ROT
+    lda (_pl),y
+    sta k_val
+    ldy #PL_CUR_PIECE
+    lda (_pl),y
+    pha
+    jsr piece_index
+    pla
+    tay
+    lda _piece_pal,y
+    sta k_val            ; palette + no flip
+    ldy #PL_CUR_X
+    lda (_pl),y
+    clc
+    adc k_x
+    sta k_x              ; board column of the piece origin
+@loop:
+    ldy k_oam
+    lda _piece_y,x
+    clc
+    adc k_y
+    cmp #PF_H
+    bcc @visible
+    lda #$FF             ; hide blocks above the visible area
+    sta _oam_buf,y
+    bne @next            ; always
+@visible:
+    ; Y pixel = (py + PF_Y) * 8 - 1 (NES OAM quirk)
+    clc
+    adc #PF_Y
+    asl
+    asl
+    asl
+    sec
+    sbc #$01
+    sta _oam_buf,y
+    lda #TILE_BLOCK
+    sta _oam_buf+1,y
+    lda k_val
+    sta _oam_buf+2,y
+    ; X pixel = (px + pf_x) * 8
+    lda _piece_x,x
+    clc
+    adc k_x
+    asl
+    asl
+    asl
+    sta _oam_buf+3,y
+@next:
+    lda k_oam
+    clc
+    adc #$04
+    sta k_oam
+    inx
+    cpx k_end
+    bne @loop
+    rts
@@ -5,40 +5,42 @@
 
 /* BG palette: black background with multiple piece colors */
 static const unsigned char bg_pal[16] = {
-    0x0F, 0x30, 0x10, 0x00,   /* BG 0: black, white, lt gray, dk gray (text + borders) */
-    0x0F, 0x2C, 0x1C, 0x0C,   /* BG 1: cyan shades (I, S pieces on BG) */
-    0x0F, 0x28, 0x18, 0x08,   /* BG 2: yellow shades (O, Z pieces on BG) */
-    0x0F, 0x24, 0x14, 0x04,   /* BG 3: purple shades (T, J pieces on BG) */
+    0x0F, 0x30, 0x10, 0x00,   /* BG 0: black, white, lt gray, dk gray (text, blocks, borders) */
+    0x0F, 0x2C, 0x1C, 0x0C,   /* BG 1: cyan shades (unused) */
+    0x0F, 0x30, 0x10, 0x00,   /* BG 2: line-clear flash, player 2 (color 1 animated) */
+    0x0F, 0x30, 0x10, 0x00,   /* BG 3: line-clear flash, player 1 (color 1 animated) */
 };
 
-/* Sprite palette: piece colors */
+/* Sprite palette: piece colors (block tile: color 2 fill, color 3 border) */
 static const unsigned char spr_pal[16] = {
-    0x0F, 0x27, 0x17, 0x07,   /* Spr 0: orange (L piece) */
-    0x0F, 0x2C, 0x1C, 0x0C,   /* Spr 1: cyan (I, S pieces) */
-    0x0F, 0x28, 0x18, 0x08,   /* Spr 2: yellow (O, Z pieces) */
-    0x0F, 0x24, 0x14, 0x04,   /* Spr 3: purple (T, J pieces) */
+    0x0F, 0x37, 0x27, 0x17,   /* Spr 0: orange (L piece) */
+    0x0F, 0x3C, 0x2C, 0x1C,   /* Spr 1: cyan (I, S pieces) */
+    0x0F, 0x38, 0x28, 0x18,   /* Spr 2: yellow (O, Z pieces) */
+    0x0F, 0x34, 0x24, 0x14,   /* Spr 3: purple (T, J pieces) */
 };
 
-/* Draw the full game screen (rendering must be off) */
-static void draw_game_screen(void)
-{
-    /* Clear entire nametable */
-    vram_adr(NTADR_A(0, 0));
-    vram_fill(TILE_BLANK, 960);
+/* Tiles of the "GAME OVER" banner: one line, or two on narrow boards */
+#if PF_W >= 9
+#define GAME_OVER_TILES 9
+#else
+#define GAME_OVER_TILES 8
+#endif
 
-    draw_border();
-    draw_playfield();
-    draw_hud_labels();
-}
+/* Number of players chosen on the title screen */
+static unsigned char title_players;
 
 void main(void)
 {
+    unsigned char i;
+
     /* Initial setup */
+    region_init();
     ppu_off();
     pal_bg(bg_pal);
     pal_spr(spr_pal);
 
     game_state = STATE_TITLE;
+    title_players = 1;
     rng_seed = 0;
 
     draw_title_screen();
@@ -48,80 +50,110 @@ void main(void)
     /* ── Main loop ── */
     while (1) {
         ppu_wait_nmi();
+        TRACE_EV(EV_FRAME);
 
         switch (game_state) {
 
         case STATE_TITLE:
             /* Tick RNG seed while on title screen */
             ++rng_seed;
-            pad_prev = pad_cur;
-            pad_cur = pad_poll(0);
-            pad_new = pad_cur & ~pad_prev;
-
-            if (pad_new & PAD_START) {
-                ppu_off();
-                start_game();
-                draw_game_screen();
-                draw_score();
-                draw_next_piece();
-                scroll(0, 0);
-                ppu_on_all();
+            player_select(0);
+            read_pad();
+
+#ifdef VS_ENABLED
+            if (pl->pad_new & PAD_SELECT) {
+                title_players = 3 - title_players;
+                draw_title_mode(title_players);
+            }
+#endif
+
+            /* Left/Right: cycle the randomizer mode */
+            if (pl->pad_new & PAD_RIGHT) {
+                rand_mode = (rand_mode == NUM_RAND_MODES - 1) ? 0 : rand_mode + 1;
+                draw_title_rand();
+            } else if (pl->pad_new & PAD_LEFT) {
+                rand_mode = rand_mode ? rand_mode - 1 : NUM_RAND_MODES - 1;
+                draw_title_rand();
+            }
+
+            /* The title stays up while the game screen is built */
+            if (pl->pad_new & PAD_START) {
+                game_state = STATE_BUILD;
+                start_game(title_players);
+                build_begin();
             }
             break;
 
-        case STATE_PLAYING:
-            do_input();
-            do_gravity();
-            if (game_state == STATE_PLAYING)
-                update_sprites();
+        case STATE_BUILD:
+            if (build_step()) {
+                ppu_nt(NT_GAME);
+                game_state = STATE_PLAYING;
+            }
             break;
 
-        case STATE_LINECLEAR:
-            ++lineclear_timer;
-            /* Flash every 4 frames */
-            if ((lineclear_timer & 3) == 0) {
-                flash_lines(lineclear_timer >> 2);
+        case STATE_PLAYING:
+            /* Both boards run their game core in the same frame */
+            for (i = 0; i < num_players && game_state == STATE_PLAYING; ++i) {
+                player_select(i);
+                if (pl->state == STATE_LINECLEAR) {
+                    TRACE_EV(EV_LINECLEAR);
+                    do_lineclear();
+                } else {
+                    TRACE_EV(EV_INPUT);
+                    do_input();
+                    TRACE_EV(EV_GRAVITY);
+                    do_gravity();
+                }
+                if (game_state == STATE_PLAYING && pl->state == STATE_PLAYING)
+                    update_sprites();
             }
-            if (lineclear_timer >= LINECLEAR_FRAMES) {
-                add_score(num_lines_clearing);
-                collapse_lines();
-                redraw_playfield_full();
-                spawn_piece();
-                draw_next_piece();
-                draw_score();
-                game_state = STATE_PLAYING;
+
+            /* Line flashes and row redraws take whatever VRAM budget is left */
+            TRACE_EV(EV_VRAM);
+            for (i = 0; i < num_players; ++i) {
+                player_select(i);
+                vram_step();
             }
             break;
 
         case STATE_GAMEOVER:
-            /* Show "GAME OVER" via vbuf */
-            if (lineclear_timer == 0) {
+            /* Let pending row redraws and flash attribute restores finish
+             * before writing over the board */
+            for (i = 0; i < num_players; ++i) {
+                player_select(i);
+                vram_step();
+            }
+
+            /* Show "GAME OVER" on the losing board via vbuf */
+            player_select(loser);
+            if (pl->lineclear_timer == 0 && pl->redraw_row >= pl->redraw_end
+                && !pl->flash_qrows && vbuf_room() >= GAME_OVER_TILES) {
                 /* Reuse lineclear_timer as "did we draw" flag */
-                lineclear_timer = 1;
-                vbuf_put(NTADR_A(PF_X + 1, PF_Y + 9), 0x27); /* G */
-                vbuf_put(NTADR_A(PF_X + 2, PF_Y + 9), 0x21); /* A */
-                vbuf_put(NTADR_A(PF_X + 3, PF_Y + 9), 0x2D); /* M */
-                vbuf_put(NTADR_A(PF_X + 4, PF_Y + 9), 0x25); /* E */
-                vbuf_put(NTADR_A(PF_X + 5, PF_Y + 9), 0x00); /*   */
-                vbuf_put(NTADR_A(PF_X + 6, PF_Y + 9), 0x2F); /* O */
-                vbuf_put(NTADR_A(PF_X + 7, PF_Y + 9), 0x36); /* V */
-                vbuf_put(NTADR_A(PF_X + 8, PF_Y + 9), 0x25); /* E */
-                vbuf_put(NTADR_A(PF_X + 9, PF_Y + 9), 0x32); /* R */
+                pl->lineclear_timer = 1;
+#if PF_W >= 9
+                vbuf_str(PF_NTADR((PF_W - 9) / 2, PF_H / 2 - 1), "GAME OVER");
+#else
+                vbuf_str(PF_NTADR((PF_W - 4) / 2, PF_H / 2 - 2), "GAME");
+                vbuf_str(PF_NTADR((PF_W - 4) / 2, PF_H / 2 - 1), "OVER");
+#endif
             }
 
-            pad_prev = pad_cur;
-            pad_cur = pad_poll(0);
-            pad_new = pad_cur & ~pad_prev;
+            player_select(0);
+            read_pad();
 
-            if (pad_new & PAD_START) {
-                lineclear_timer = 0;
-                ppu_off();
-                draw_title_screen();
-                scroll(0, 0);
+            if (pl->pad_new & PAD_START) {
+                for (i = 0; i < num_players; ++i) {
+                    player_select(i);
+                    hide_sprites();
+                }
+                /* The title is still in its nametable, labels and all */
+                ppu_nt(NT_TITLE);
                 game_state = STATE_TITLE;
-                ppu_on_all();
             }
             break;
         }
+
+        TRACE_EV(EV_VBUF | vbuf_len);
+        TRACE_EV(EV_IDLE);
     }
 }
@@ -11,6 +11,14 @@
 #define NTADR_C(x,y) ((unsigned int)(0x2800 | ((y) << 5) | (x)))
 #define NTADR_D(x,y) ((unsigned int)(0x2C00 | ((y) << 5) | (x)))
 
+/* Attribute table A/B address of byte i (0..63) */
+#define ATADR_A(i) ((unsigned int)(0x23C0 + (i)))
+#define ATADR_B(i) ((unsigned int)(0x27C0 + (i)))
+
+/* Palette RAM address of color i (0..31), for single colors queued
+ * through the VRAM buffer */
+#define PALADR(i) ((unsigned int)(0x3F00 + (i)))
+
 /* Controller button masks */
 #define PAD_A       0x80
 #define PAD_B       0x40
@@ -30,6 +38,7 @@
 /* Tile constants for game graphics */
 #define TILE_EMPTY  0x60
 #define TILE_BLOCK  0x61
+#define TILE_FLASH  0x62
 #define TILE_BRD_TL 0x68
 #define TILE_BRD_TR 0x69
 #define TILE_BRD_BL 0x6A
@@ -38,13 +47,61 @@
 #define TILE_BRD_V  0x6D
 #define TILE_BLANK  0x00
 
+/* ASCII tile offset: tile_index = char - 0x20 */
+#define CHR(c) ((unsigned char)((c) - 0x20))
+
 /* OAM buffer (256 bytes at $0200) */
 extern unsigned char oam_buf[256];
 
-/* VRAM update buffer and length */
-extern unsigned char vram_buf[128];
+/* TV region, detected at reset by timing a frame (crt0.s) */
+#define REGION_NTSC  0
+#define REGION_PAL   1
+#define REGION_DENDY 2
+extern unsigned char region;
+#pragma zpsym("region")
+
+/* VRAM update buffer and length (entries of 3 bytes: addr_hi, addr_lo, tile).
+ * vbuf_budget is how many tiles the NMI can drain in one frame in this
+ * region (set at reset by crt0.s): 42 on NTSC/Dendy (60 with EXT_VBLANK,
+ * which keeps the top 8 scanlines in forced blank), and the whole
+ * VBUF_CAP buffer in PAL's longer vblank. Everything that queues writes
+ * keeps within vbuf_room().
+ */
+#define VBUF_CAP 84
+#define vbuf_room() ((unsigned char)(vbuf_budget - vbuf_len))
+extern unsigned char vram_buf[VBUF_CAP * 3];
 extern unsigned char vbuf_len;
 #pragma zpsym("vbuf_len")
+extern unsigned char vbuf_budget;
+#pragma zpsym("vbuf_budget")
+
+/* PRG banking (UNROM builds): banks 0-2 map at $8000, and the last bank,
+ * with all code and the NMI, is fixed at $C000. bank_use() switches only
+ * when needed and is a no-op on NROM, where all of PRG is always mapped.
+ */
+#ifdef UNROM
+extern unsigned char prg_bank;
+#pragma zpsym("prg_bank")
+void __fastcall__ bank_set(unsigned char bank);
+#define bank_use(b) do { if (prg_bank != (b)) bank_set(b); } while (0)
+#else
+#define bank_use(b)
+#endif
+
+/* Debug event trace (TRACE builds). Each marker byte is written to
+ * TRACE_PORT, an unused CPU test register that shows up in emulator trace
+ * logs, and appended to the trace_buf ring in RAM for dumps (the NMI's
+ * markers to a ring of their own, see trace_nmi_ev in neslib.s).
+ * tools/trace2chrome.py turns either into a Chrome trace-event timeline.
+ */
+#define TRACE_PORT 0x401F
+#define TRACE_LEN  64
+#ifdef TRACE
+void __fastcall__ trace_ev(unsigned char ev);
+#define TRACE_EV(ev) trace_ev(ev)
+#else
+#define TRACE_EV(ev)
+#endif
 
 /* Wait for next NMI (vblank). Requires NMI to be enabled. */
 void __fastcall__ ppu_wait_nmi(void);
@@ -61,6 +118,9 @@ void __fastcall__ ppu_on_all(void);
 /* Turn off all rendering */
 void __fastcall__ ppu_off(void);
 
+/* Select the nametable shown (0-3) from the next NMI on */
+void __fastcall__ ppu_nt(unsigned char nt);
+
 /* Set PPU mask directly */
 void __fastcall__ ppu_mask(unsigned char mask);
 
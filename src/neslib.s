@@ -8,17 +8,44 @@
 
 .export _ppu_wait_nmi
 .export _ppu_on_bg, _ppu_on_spr, _ppu_on_all, _ppu_off
-.export _ppu_mask
+.export _ppu_mask, _ppu_nt
 .export _vram_adr, _vram_put, _vram_write, _vram_fill
 .export _pal_all, _pal_bg, _pal_spr, _pal_col
 .export _pad_poll
 .export _scroll
+.ifdef TRACE
+.export _trace_ev, _trace_buf
+.export trace_nmi_ev, _trace_nmi_buf, _trace_nmi_at
+.exportzp _trace_pos, _trace_nmi_pos
+.endif
+.ifdef UNROM
+.export _bank_set
+.exportzp _prg_bank
+.endif
+
+TRACE_PORT = $401F         ; must match neslib.h
+TRACE_LEN  = 64
+TRACE_NMI_LEN = 16         ; must match tools/trace2chrome.py
 
 ; Temp zero-page pointers for indirect addressing
 .segment "ZEROPAGE"
 tmp_ptr:   .res 2
 tmp_len:   .res 2
 tmp_val:   .res 1
+.ifdef TRACE
+_trace_pos: .res 1         ; next write index into trace_buf
+_trace_nmi_pos: .res 1     ; next write index into trace_nmi_buf
+.endif
+.ifdef UNROM
+_prg_bank:  .res 1         ; PRG bank mapped at $8000
+.endif
+
+.ifdef TRACE
+.segment "BSS"
+_trace_buf: .res TRACE_LEN ; ring of the last TRACE_LEN event bytes
+_trace_nmi_buf: .res TRACE_NMI_LEN ; the NMI's own ring of event bytes
+_trace_nmi_at:  .res TRACE_NMI_LEN ; trace_pos when each was written
+.endif
 
 .segment "CODE"
 
@@ -82,6 +109,19 @@ _ppu_off:
     sta $2001
     rts
 
+; ────────────────────────────────────────────────
+; void __fastcall__ ppu_nt(unsigned char nt)
+; Nametable select bits of PPU_CTRL; the NMI writes them after draining
+; the VRAM buffer, so the switch lands with the frame's last updates
+; ────────────────────────────────────────────────
+_ppu_nt:
+    sta tmp_val
+    lda ppu_ctrl_var
+    and #$FC
+    ora tmp_val
+    sta ppu_ctrl_var
+    rts
+
 ; ────────────────────────────────────────────────
 ; void __fastcall__ ppu_mask(unsigned char mask)
 ; ────────────────────────────────────────────────
@@ -276,6 +316,43 @@ _pad_poll:
     sta pad_state
     rts
 
+.ifdef TRACE
+; ────────────────────────────────────────────────
+; void __fastcall__ trace_ev(unsigned char ev)
+; A = event byte; clobbers X
+; ────────────────────────────────────────────────
+_trace_ev:
+    sta TRACE_PORT
+    ldx _trace_pos
+    sta _trace_buf,x
+    inx
+    txa
+    and #TRACE_LEN-1
+    sta _trace_pos
+    rts
+
+; ────────────────────────────────────────────────
+; trace_nmi_ev: trace_ev for the NMI handler
+; A = event byte; clobbers X
+;
+; The NMI can land inside trace_ev, between reading and storing
+; trace_pos, and sei does not hold it off. So it never touches
+; trace_buf or trace_pos: it has its own ring, and notes the main
+; loop's trace_pos with each entry to place it among the main events.
+; ────────────────────────────────────────────────
+trace_nmi_ev:
+    sta TRACE_PORT
+    ldx _trace_nmi_pos
+    sta _trace_nmi_buf,x
+    lda _trace_pos
+    sta _trace_nmi_at,x
+    inx
+    txa
+    and #TRACE_NMI_LEN-1
+    sta _trace_nmi_pos
+    rts
+.endif
+
 ; ────────────────────────────────────────────────
 ; void __fastcall__ scroll(unsigned int x, unsigned int y)
 ; fastcall: y in A/X, x on C stack
@@ -285,3 +362,21 @@ _scroll:
     jsr popax
     sta scroll_x
     rts
+
+.ifdef UNROM
+; ────────────────────────────────────────────────
+; void __fastcall__ bank_set(unsigned char bank)
+; Map PRG bank 0-2 at $8000. UNROM has bus conflicts, so the bank number
+; is written over a ROM byte that holds the same value. The NMI and all
+; code live in the fixed bank and never depend on this mapping.
+; ────────────────────────────────────────────────
+_bank_set:
+    sta _prg_bank
+    tax
+    sta bank_table,x
+    rts
+
+.segment "RODATA"
+bank_table:
+    .byte $00, $01, $02
+.endif
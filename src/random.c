@@ -0,0 +1,159 @@
+/* random.c - Piece randomizer: classic reroll, 7-bag, history
+ *
+ * Every mode is division-free: pieces are picked from a byte of the LFSR
+ * through a small fold table. The randomizer mode is chosen on the title
+ * screen and applies to both players; each player has its own bag/history.
+ */
+
+#include "neslib.h"
+#include "tetris.h"
+
+unsigned int rng_seed;
+unsigned char rand_mode;
+
+/* r % 7 without division: since 16 = 2 (mod 7), r % 7 = (2*(r>>4) + (r&15)) % 7,
+ * and the folded value is at most 45.
+ */
+static const unsigned char mod7_fold[46] = {
+    0,1,2,3,4,5,6, 0,1,2,3,4,5,6, 0,1,2,3,4,5,6, 0,1,2,3,4,5,6,
+    0,1,2,3,4,5,6, 0,1,2,3,4,5,6, 0,1,2,3,
+};
+#define MOD7(r) mod7_fold[(((r) >> 3) & 0x1E) + ((r) & 0x0F)]
+
+/* Bit per piece type, for the history mask */
+static const unsigned char piece_bit[NUM_PIECES] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40,
+};
+
+/* History mode: pieces remembered and rolls per pick */
+#define HIST_ROLLS 4
+
+/* Taps fed back by the low byte of the LFSR over 8 steps: the feedback
+ * bits are exactly that byte, and the step is linear, so the table is
+ * split by nibble. Generated from the one-bit step with taps 0xB400.
+ */
+static const unsigned int lfsr_fb_lo[16] = {
+    0x0000, 0x0168, 0x02D0, 0x03B8, 0x05A0, 0x04C8, 0x0770, 0x0618,
+    0x0B40, 0x0A28, 0x0990, 0x08F8, 0x0EE0, 0x0F88, 0x0C30, 0x0D58,
+};
+static const unsigned int lfsr_fb_hi[16] = {
+    0x0000, 0x1680, 0x2D00, 0x3B80, 0x5A00, 0x4C80, 0x7700, 0x6180,
+    0xB400, 0xA280, 0x9900, 0x8F80, 0xEE00, 0xF880, 0xC300, 0xD580,
+};
+
+/* ── RNG: 16-bit Galois LFSR, 8 steps per byte ──
+ * One step per byte would leave consecutive bytes sharing 7 bits, which
+ * skews the bag keys and the re-rolls that take bytes back to back.
+ */
+unsigned char rand_byte(void)
+{
+    unsigned char b;
+    b = (unsigned char)rng_seed;
+    rng_seed = (rng_seed >> 8) ^ lfsr_fb_lo[b & 0x0F] ^ lfsr_fb_hi[b >> 4];
+    return (unsigned char)rng_seed;
+}
+
+/* ── 7-bag: insert the next piece into the staging bag ──
+ * The staging bag is kept sorted by a random key per piece, so after all
+ * 7 insertions it is a random permutation. One insertion costs at most
+ * 6 shifts and is done once per frame by rand_tick().
+ */
+static void bag_insert(void)
+{
+    unsigned char j, key;
+
+    /* Both LFSR bytes summed: bytes taken at a fixed spacing, as in one
+     * shuffle, are linearly related, and sorting on them is skewed */
+    key = rand_byte();
+    key += (unsigned char)(rng_seed >> 8);
+    j = pl->sb_n;
+    /* A coin flip orders equal keys, or earlier pieces would win ties */
+    while (j && (pl->sb_key[j - 1] > key
+                 || (pl->sb_key[j - 1] == key && (rand_byte() & 1)))) {
+        pl->sb_key[j] = pl->sb_key[j - 1];
+        pl->sb_piece[j] = pl->sb_piece[j - 1];
+        --j;
+    }
+    pl->sb_key[j] = key;
+    pl->sb_piece[j] = pl->sb_n;
+    ++pl->sb_n;
+}
+
+/* Move the finished staging bag into play and start building the next */
+static void bag_refill(void)
+{
+    unsigned char i;
+
+    /* Finish the shuffle if pieces came faster than one per 7 frames */
+    while (pl->sb_n < NUM_PIECES)
+        bag_insert();
+
+    for (i = 0; i < NUM_PIECES; ++i)
+        pl->bag[i] = pl->sb_piece[i];
+    pl->bag_pos = 0;
+    pl->sb_n = 0;
+}
+
+/* ── Reset the active player's randomizer state ── */
+void rand_init(void)
+{
+    pl->sb_n = 0;
+    bag_refill();
+
+    /* History starts full of S/Z so the first pieces avoid them */
+    pl->hist[0] = PIECE_Z;
+    pl->hist[1] = PIECE_S;
+    pl->hist[2] = PIECE_Z;
+    pl->hist[3] = PIECE_S;
+}
+
+/* ── Per-frame tick: advance the LFSR and the incremental bag shuffle ── */
+void rand_tick(void)
+{
+    rand_byte();
+    if (rand_mode == RAND_BAG && pl->sb_n < NUM_PIECES)
+        bag_insert();
+}
+
+unsigned char next_random_piece(void)
+{
+    unsigned char p, i, mask;
+
+    switch (rand_mode) {
+
+    case RAND_BAG:
+        if (pl->bag_pos >= NUM_PIECES)
+            bag_refill();
+        p = pl->bag[pl->bag_pos];
+        ++pl->bag_pos;
+        break;
+
+    case RAND_HISTORY:
+        /* Roll up to HIST_ROLLS times for a piece not in the history */
+        mask = piece_bit[pl->hist[0]] | piece_bit[pl->hist[1]]
+             | piece_bit[pl->hist[2]] | piece_bit[pl->hist[3]];
+        for (i = 0; i < HIST_ROLLS; ++i) {
+            p = rand_byte();
+            p = MOD7(p);
+            if (!(mask & piece_bit[p]))
+                break;
+        }
+        pl->hist[3] = pl->hist[2];
+        pl->hist[2] = pl->hist[1];
+        pl->hist[1] = pl->hist[0];
+        pl->hist[0] = p;
+        break;
+
+    default:
+        /* Classic: re-roll once if same as the piece it follows, the
+         * preview about to come into play (reduces repeats) */
+        p = rand_byte();
+        p = MOD7(p);
+        if (p == pl->next_piece) {
+            p = rand_byte();
+            p = MOD7(p);
+        }
+        break;
+    }
+    return p;
+}
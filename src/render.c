@@ -3,9 +3,6 @@
 #include "neslib.h"
 #include "tetris.h"
 
-/* ASCII tile offset: tile_index = char - 0x20 */
-#define CHR(c) ((unsigned char)((c) - 0x20))
-
 /* Queue one VRAM update: addr_hi, addr_lo, tile */
 void vbuf_put(unsigned int adr, unsigned char tile)
 {
@@ -17,6 +14,16 @@ void vbuf_put(unsigned int adr, unsigned char tile)
     ++vbuf_len;
 }
 
+/* Queue a string via the VRAM buffer, one entry per character */
+void vbuf_str(unsigned int adr, const char *s)
+{
+    while (*s) {
+        vbuf_put(adr, CHR(*s));
+        ++adr;
+        ++s;
+    }
+}
+
 /* Write a string directly to VRAM at current PPU address (rendering must be off) */
 static void write_str(const char *s)
 {
@@ -26,228 +33,447 @@ static void write_str(const char *s)
     }
 }
 
-/* Update 4 OAM sprites for the active falling piece */
-void update_sprites(void)
+#ifndef ASM_KERNELS
+
+/* Update the active player's 4 OAM sprites for its falling piece */
+void __fastcall__ update_sprites(void)
 {
-    unsigned char i, idx, px, py, pal;
-    idx = (unsigned char)(cur_piece << 4) | (unsigned char)(cur_rot << 2);
-    pal = piece_pal[cur_piece];
+    unsigned char i, idx, px, py, pal, o;
+    idx = (unsigned char)(pl->cur_piece << 4) | (unsigned char)(pl->cur_rot << 2);
+    pal = piece_pal[pl->cur_piece];
+    o = pl->oam;
 
-    for (i = 0; i < 4; ++i) {
-        px = (unsigned char)((signed char)piece_x[idx + i] + cur_x);
-        py = (unsigned char)((signed char)piece_y[idx + i] + cur_y);
+    for (i = 0; i < 4; ++i, o += 4) {
+        px = (unsigned char)((signed char)piece_x[idx + i] + pl->cur_x);
+        py = (unsigned char)((signed char)piece_y[idx + i] + pl->cur_y);
 
         /* Skip blocks above visible area */
         if (py >= PF_H) {
-            oam_buf[i * 4]     = 0xFF; /* hide */
+            oam_buf[o]     = 0xFF; /* hide */
             continue;
         }
 
         /* OAM: y, tile, attr, x */
-        oam_buf[i * 4]     = (unsigned char)((py + PF_Y) * 8 - 1); /* Y pixel (-1 for NES OAM quirk) */
-        oam_buf[i * 4 + 1] = TILE_BLOCK;       /* tile */
-        oam_buf[i * 4 + 2] = pal;              /* palette + no flip */
-        oam_buf[i * 4 + 3] = (unsigned char)((px + PF_X) * 8); /* X pixel */
+        oam_buf[o]     = (unsigned char)((py + PF_Y) * 8 - 1); /* Y pixel (-1 for NES OAM quirk) */
+        oam_buf[o + 1] = TILE_BLOCK;       /* tile */
+        oam_buf[o + 2] = pal;              /* palette + no flip */
+        oam_buf[o + 3] = (unsigned char)((px + pl->pf_x) * 8); /* X pixel */
     }
 }
 
-/* Hide all 4 piece sprites off-screen */
-void hide_sprites(void)
-{
-    unsigned char i;
-    for (i = 0; i < 4; ++i) {
-        oam_buf[i * 4] = 0xFF;
-    }
-}
+#endif /* ASM_KERNELS */
 
-/* Draw the playfield border (rendering must be off) */
-void draw_border(void)
+/* Game nametable's attribute table as last queued or written */
+static unsigned char attr_shadow[64];
+
+/* Clear both nametables and their attribute tables (rendering must be off) */
+void clear_screen(void)
 {
     unsigned char i;
 
-    /* Top border: row PF_Y-1, cols PF_X-1 to PF_X+PF_W */
-    vram_adr(NTADR_A(PF_X - 1, PF_Y - 1));
-    vram_put(TILE_BRD_TL);
-    for (i = 0; i < PF_W; ++i)
-        vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_TR);
+    vram_adr(NTADR_A(0, 0));
+    vram_fill(TILE_BLANK, 2048);
+    for (i = 0; i < 64; ++i)
+        attr_shadow[i] = 0;
+}
 
-    /* Side borders: rows PF_Y to PF_Y+PF_H-1 */
-    for (i = 0; i < PF_H; ++i) {
-        vram_adr(NTADR_A(PF_X - 1, PF_Y + i));
-        vram_put(TILE_BRD_V);
-        vram_adr(NTADR_A(PF_X + PF_W, PF_Y + i));
-        vram_put(TILE_BRD_V);
+/* Hide the active player's 4 piece sprites off-screen */
+void hide_sprites(void)
+{
+    unsigned char i, o;
+    o = pl->oam;
+    for (i = 0; i < 4; ++i, o += 4) {
+        oam_buf[o] = 0xFF;
     }
-
-    /* Bottom border */
-    vram_adr(NTADR_A(PF_X - 1, PF_Y + PF_H));
-    vram_put(TILE_BRD_BL);
-    for (i = 0; i < PF_W; ++i)
-        vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_BR);
 }
 
-/* Draw all playfield cells from the playfield[] array (rendering must be off) */
-void draw_playfield(void)
+/* Draw next piece preview inside the box (via VRAM buffer).
+ * Each of the 4x2 preview cells is written exactly once.
+ */
+void draw_next_piece(void)
 {
-    unsigned char r, c;
-    for (r = 0; r < PF_H; ++r) {
-        vram_adr(PF_NTADR(0, r));
-        for (c = 0; c < PF_W; ++c) {
-            if (playfield[r * PF_W + c])
-                vram_put(TILE_BLOCK);
-            else
-                vram_put(TILE_EMPTY);
+    unsigned char i, idx, bx, by, mask;
+    unsigned int adr;
+
+    /* Build an 8-bit mask of the cells covered by the piece (rotation 0) */
+    mask = 0;
+    idx = (unsigned char)(pl->next_piece << 4);
+    for (i = 0; i < 4; ++i) {
+        mask |= (unsigned char)(1 << ((piece_y[idx + i] << 2) + piece_x[idx + i]));
+    }
+
+    for (by = 0; by < 2; ++by) {
+        adr = GAME_NTADR(pl->hud_x + NEXT_DX + 1, pl->hud_y + NEXT_DY + 2 + by);
+        for (bx = 0; bx < 4; ++bx) {
+            vbuf_put(adr + bx, (mask & 1) ? TILE_BLOCK : TILE_EMPTY);
+            mask >>= 1;
         }
     }
 }
 
-/* Draw HUD labels (rendering must be off) */
-void draw_hud_labels(void)
+/* Draw the title screen into nametable A (rendering must be off) */
+void draw_title_screen(void)
 {
-    /* "SCORE" */
-    vram_adr(NTADR_A(SCORE_X, SCORE_Y));
-    write_str("SCORE");
+    clear_screen();
 
-    /* "LINES" */
-    vram_adr(NTADR_A(LINES_X, LINES_Y));
-    write_str("LINES");
-
-    /* "LEVEL" */
-    vram_adr(NTADR_A(LEVEL_X, LEVEL_Y));
-    write_str("LEVEL");
-
-    /* "NEXT" */
-    vram_adr(NTADR_A(NEXT_X, NEXT_Y));
-    write_str("NEXT");
+    /* Title */
+    vram_adr(NTADR_A(9, 10));
+    write_str("NESSY TETRIS");
 
-    /* Next piece box border */
-    vram_adr(NTADR_A(NEXT_X, NEXT_Y + 1));
-    vram_put(TILE_BRD_TL);
-    vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_TR);
+    /* Prompt */
+    vram_adr(NTADR_A(9, 16));
+    write_str("PRESS START");
 
-    vram_adr(NTADR_A(NEXT_X, NEXT_Y + 2));
-    vram_put(TILE_BRD_V);
-    vram_put(TILE_EMPTY);
-    vram_put(TILE_EMPTY);
-    vram_put(TILE_EMPTY);
-    vram_put(TILE_EMPTY);
-    vram_put(TILE_BRD_V);
+#ifdef VS_ENABLED
+    /* Mode select */
+    vram_adr(NTADR_A(TITLE_MODE_X, TITLE_MODE_Y));
+    write_str("SELECT: 1 PLAYER");
+#endif
 
-    vram_adr(NTADR_A(NEXT_X, NEXT_Y + 3));
-    vram_put(TILE_BRD_V);
-    vram_put(TILE_EMPTY);
-    vram_put(TILE_EMPTY);
-    vram_put(TILE_EMPTY);
-    vram_put(TILE_EMPTY);
-    vram_put(TILE_BRD_V);
+    /* Randomizer select */
+    vram_adr(NTADR_A(TITLE_RAND_X, TITLE_RAND_Y));
+    write_str("RANDOM: CLASSIC");
+}
 
-    vram_adr(NTADR_A(NEXT_X, NEXT_Y + 4));
-    vram_put(TILE_BRD_BL);
-    vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_H);
-    vram_put(TILE_BRD_BR);
+/* Update the title screen mode label (via VRAM buffer) */
+void draw_title_mode(unsigned char players_count)
+{
+    vbuf_str(NTADR_A(TITLE_MODE_X + 8, TITLE_MODE_Y),
+             players_count > 1 ? "VERSUS  " : "1 PLAYER");
 }
 
-/* Draw score digits via VRAM buffer (6 BCD digits) */
-void draw_score(void)
+/* Update the title screen randomizer label (via VRAM buffer) */
+void draw_title_rand(void)
 {
-    unsigned char i;
-    unsigned int adr;
+    static const char * const names[NUM_RAND_MODES] = {
+        "CLASSIC", "7-BAG  ", "HISTORY",
+    };
+    vbuf_str(NTADR_A(TITLE_RAND_X + 8, TITLE_RAND_Y), names[rand_mode]);
+}
 
-    /* Score: 3 bytes BCD = 6 digits */
-    adr = NTADR_A(SCORE_X, SCORE_Y + 1);
-    for (i = 0; i < 3; ++i) {
-        vbuf_put(adr, CHR('0') + (score[i] >> 4));
-        ++adr;
-        vbuf_put(adr, CHR('0') + (score[i] & 0x0F));
-        ++adr;
+/* ── Off-screen game screen builder ──
+ * A new game screen is built in the game nametable through the VRAM queue,
+ * a strip of tiles at a time within the frame's budget, while the title
+ * stays on screen; main then shows it with a nametable-select flip. The
+ * game nametable keeps the last game's screen: a game with the same layout
+ * overwrites every tile that screen had, otherwise it is erased first.
+ */
+
+/* Build passes, in order */
+#define BUILD_ERASE 0   /* blank the previous layout's strips */
+#define BUILD_DRAW  1   /* borders, board cells, labels, next box */
+#define BUILD_ATTR  2   /* flash attributes back to palette 0 */
+#define BUILD_HUD   3   /* digits and next piece, per player */
+
+/* HUD strips, relative to the HUD origin: labels, and the digit rows
+ * (drawn by hud.c, so only erased here) */
+typedef struct {
+    unsigned char dx;
+    unsigned char dy;
+    unsigned char len;
+    const char *text;
+} hud_strip_t;
+
+static const hud_strip_t hud_strips[] = {
+    { SCORE_DX, SCORE_DY,     5, "SCORE" },
+    { SCORE_DX, SCORE_DY + 1, 6, 0 },
+    { LINES_DX, LINES_DY,     5, "LINES" },
+    { LINES_DX, LINES_DY + 1, 4, 0 },
+    { LEVEL_DX, LEVEL_DY,     5, "LEVEL" },
+    { LEVEL_DX, LEVEL_DY + 1, 2, 0 },
+    { NEXT_DX,  NEXT_DY,      4, "NEXT" },
+};
+#define NUM_HUD_STRIPS (sizeof(hud_strips) / sizeof(hud_strips[0]))
+
+/* Strips per player: board border and rows, HUD strips, next box rows */
+#define BOARD_STRIPS (PF_H + 2)
+#define BOX_STRIPS   4
+#define NUM_STRIPS   (BOARD_STRIPS + NUM_HUD_STRIPS + BOX_STRIPS)
+#define STRIP_MAX    (PF_W + 2)
+
+static unsigned char build_pass;
+static unsigned char build_n;       /* player being built */
+static unsigned char build_s;       /* strip of that player */
+static unsigned char build_i;       /* tiles of that strip queued */
+static unsigned char nt_players;    /* layout on the game nametable (0 = blank) */
+
+static unsigned char strip_buf[STRIP_MAX];
+static unsigned int strip_adr;
+
+/* Fill strip_buf with row i of a frame around w x h inner tiles: the top
+ * border, the bottom border, or side borders around empty cells */
+static void frame_row(unsigned char w, unsigned char h, unsigned char i)
+{
+    unsigned char c, m;
+
+    if (i == 0) {
+        strip_buf[0] = TILE_BRD_TL;
+        m = TILE_BRD_H;
+        strip_buf[w + 1] = TILE_BRD_TR;
+    } else if (i > h) {
+        strip_buf[0] = TILE_BRD_BL;
+        m = TILE_BRD_H;
+        strip_buf[w + 1] = TILE_BRD_BR;
+    } else {
+        strip_buf[0] = TILE_BRD_V;
+        m = TILE_EMPTY;
+        strip_buf[w + 1] = TILE_BRD_V;
     }
+    for (c = 1; c <= w; ++c)
+        strip_buf[c] = m;
+}
 
-    /* Lines: 2 bytes BCD = 4 digits */
-    adr = NTADR_A(LINES_X, LINES_Y + 1);
-    for (i = 0; i < 2; ++i) {
-        vbuf_put(adr, CHR('0') + (lines[i] >> 4));
-        ++adr;
-        vbuf_put(adr, CHR('0') + (lines[i] & 0x0F));
-        ++adr;
+/* Load strip s of player n in a count-player layout into strip_buf and
+ * strip_adr. Returns its length, 0 if the pass has nothing to draw there.
+ */
+static unsigned char load_strip(unsigned char n, unsigned char count, unsigned char s)
+{
+    const hud_strip_t *h;
+    const unsigned char *src;
+    unsigned char k, c;
+
+    k = LAYOUT(n, count);
+
+    if (s < BOARD_STRIPS) {
+        frame_row(PF_W, PF_H, s);
+        if (s && s <= PF_H) {
+            src = playfields[n] + row_ofs[s - 1];
+            for (c = 0; c < PF_W; ++c) {
+                if (src[c])
+                    strip_buf[c + 1] = TILE_BLOCK;
+            }
+        }
+        strip_adr = GAME_NTADR(layout_pf_x[k] - 1, PF_Y - 1 + s);
+        return PF_W + 2;
+    }
+    s -= BOARD_STRIPS;
+
+    if (s < NUM_HUD_STRIPS) {
+        h = &hud_strips[s];
+        if (!h->text && build_pass != BUILD_ERASE)
+            return 0;
+        for (c = 0; c < h->len && h->text; ++c)
+            strip_buf[c] = CHR(h->text[c]);
+        strip_adr = GAME_NTADR(layout_hud_x[k] + h->dx, layout_hud_y[k] + h->dy);
+        return h->len;
     }
+    s -= NUM_HUD_STRIPS;
 
-    /* Level: 2 digits from level byte */
-    adr = NTADR_A(LEVEL_X, LEVEL_Y + 1);
-    vbuf_put(adr, CHR('0') + (level / 10));
-    vbuf_put(adr + 1, CHR('0') + (level % 10));
+    frame_row(4, 2, s);
+    strip_adr = GAME_NTADR(layout_hud_x[k] + NEXT_DX, layout_hud_y[k] + NEXT_DY + 1 + s);
+    return 6;
 }
 
-/* Draw next piece preview inside the box (via VRAM buffer) */
-void draw_next_piece(void)
+/* Start building the screen for the game set up by start_game() */
+void build_begin(void)
 {
-    unsigned char i, idx, bx, by;
-    unsigned int adr;
+    build_pass = (nt_players && nt_players != num_players) ? BUILD_ERASE : BUILD_DRAW;
+    build_n = 0;
+    build_s = 0;
+    build_i = 0;
+}
 
-    /* Clear the 4x2 preview area first */
-    for (by = 0; by < 2; ++by) {
-        adr = NTADR_A(NEXT_X + 1, NEXT_Y + 2 + by);
-        for (bx = 0; bx < 4; ++bx) {
-            vbuf_put(adr + bx, TILE_EMPTY);
+/* Queue the next part of the game screen into what is left of the VRAM
+ * budget. Returns 1 once all of it is queued.
+ */
+unsigned char build_step(void)
+{
+    unsigned char count, len;
+
+    while (build_pass <= BUILD_DRAW) {
+        count = build_pass == BUILD_ERASE ? nt_players : num_players;
+        if (build_n == count) {
+            ++build_pass;
+            build_n = 0;
+            continue;
+        }
+        len = load_strip(build_n, count, build_s);
+        while (build_i < len) {
+            if (!vbuf_room())
+                return 0;
+            vbuf_put(strip_adr + build_i,
+                     build_pass == BUILD_ERASE ? TILE_BLANK : strip_buf[build_i]);
+            ++build_i;
+        }
+        build_i = 0;
+        if (++build_s == NUM_STRIPS) {
+            build_s = 0;
+            ++build_n;
         }
     }
 
-    /* Draw next piece blocks */
-    idx = (unsigned char)(next_piece << 4); /* rotation 0 */
-    for (i = 0; i < 4; ++i) {
-        bx = piece_x[idx + i];
-        by = piece_y[idx + i];
-        adr = NTADR_A(NEXT_X + 1 + bx, NEXT_Y + 2 + by);
-        vbuf_put(adr, TILE_BLOCK);
+    /* Attribute bytes a line-clear flash left behind */
+    if (build_pass == BUILD_ATTR) {
+        for (; build_i < 64; ++build_i) {
+            if (attr_shadow[build_i]) {
+                if (!vbuf_room())
+                    return 0;
+                vbuf_put(GAME_ATADR(build_i), 0);
+                attr_shadow[build_i] = 0;
+            }
+        }
+        build_pass = BUILD_HUD;
     }
+
+    while (build_n < num_players) {
+        if (vbuf_room() < HUD_DIGITS + 8)
+            return 0;
+        player_select(build_n);
+        hud_reset();
+        hud_update();
+        draw_next_piece();
+        ++build_n;
+    }
+
+    nt_players = num_players;
+    return 1;
 }
 
-/* Draw title screen (rendering must be off) */
-void draw_title_screen(void)
+/* ── Palette-driven line-clear flash ──
+ * The cleared rows get TILE_FLASH (solid color 1) once, and their attribute
+ * quadrants are moved to the player's flash palette, whose colors 2 and 3
+ * match palette 0 so blocks and borders sharing those quadrants look the
+ * same. Each phase is then a single palette color change, queued as one
+ * VRAM entry at its palette address: it costs the NMI what a tile does and
+ * counts against the budget. pal_col() would set pal_dirty instead, and
+ * the NMI's 32-byte palette upload does not fit next to a full drain.
+ */
+
+/* Flash color per phase (lineclear_timer / 4), then FLASH_OFF. Phase 0 is
+ * palette 0's color 1, so the flash tiles look right before their
+ * attributes are in.
+ */
+static const unsigned char flash_colors[FLASH_OFF + 1] = {
+    0x30, 0x0F, 0x30, 0x10, 0x00, 0x00, 0x00, 0x0F,
+};
+
+/* Queue the active player's flash color for a phase */
+void flash_phase(unsigned char phase)
 {
-    /* Clear nametable */
-    vram_adr(NTADR_A(0, 0));
-    vram_fill(TILE_BLANK, 960);
+    vbuf_put(PALADR((FLASH_PAL(pl->idx) << 2) + 1), flash_colors[phase]);
+}
 
-    /* Title */
-    vram_adr(NTADR_A(9, 10));
-    write_str("NESSY TETRIS");
+/* Bit per attribute quadrant row (two tile rows) of the nametable */
+static const unsigned int qrow_bit[15] = {
+    0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+    0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000,
+};
+
+/* Set the attribute quadrants over the board columns in quadrant row q to
+ * palette p, queue the changed bytes (at most ATTR_ROW_BYTES) and note in
+ * pl->flash_qrows whether the row is on the flash palette.
+ */
+static void flash_attr_qrow(unsigned char q, unsigned char p)
+{
+    unsigned char x, i, s, last;
+
+    last = 0xFF;
+    for (x = pl->pf_x & 0xFE; x < pl->pf_x + PF_W; x += 2) {
+        i = ((q >> 1) << 3) + (x >> 2);
+        if (i != last && last != 0xFF)
+            vbuf_put(GAME_ATADR(last), attr_shadow[last]);
+        s = ((q & 1) << 2) | (x & 2);
+        attr_shadow[i] = (attr_shadow[i] & ~(3 << s)) | (p << s);
+        last = i;
+    }
+    vbuf_put(GAME_ATADR(last), attr_shadow[last]);
 
-    /* Prompt */
-    vram_adr(NTADR_A(9, 16));
-    write_str("PRESS START");
+    if (p)
+        pl->flash_qrows |= qrow_bit[q];
+    else
+        pl->flash_qrows &= ~qrow_bit[q];
+}
+
+/* Move cleared line k's quadrant row to the flash palette, unless a line
+ * sharing it already did */
+static void flash_attr_line(unsigned char k)
+{
+    unsigned char q;
+
+    q = (pl->lines_to_clear[k] + PF_Y) >> 1;
+    if (!(pl->flash_qrows & qrow_bit[q]))
+        flash_attr_qrow(q, FLASH_PAL(pl->idx));
+}
+
+/* Put the first quadrant row still on the flash palette back to palette 0 */
+static void flash_restore_qrow(void)
+{
+    unsigned char q;
+
+    for (q = 0; !(pl->flash_qrows & qrow_bit[q]); ++q)
+        ;
+    flash_attr_qrow(q, 0);
+}
+
+/* Mark playfield rows [from, to) of the active player for redraw */
+void redraw_rows(unsigned char from, unsigned char to)
+{
+    /* Merge with a redraw that is still in progress */
+    if (pl->redraw_row < pl->redraw_end) {
+        if (pl->redraw_row < from)
+            from = pl->redraw_row;
+        if (pl->redraw_end > to)
+            to = pl->redraw_end;
+    }
+    pl->redraw_row = from;
+    pl->redraw_end = to;
 }
 
-/* Flash clearing lines: phase toggles block/empty */
-void flash_lines(unsigned char phase)
+/* Queue the active player's deferred updates (changed HUD digits, line-clear
+ * flash tiles and attributes, then pending playfield rows) into whatever
+ * VRAM budget is left this frame.
+ * Runs after both boards' game logic so locks, previews and scores always
+ * get their writes first; the rest waits or trickles over later frames.
+ */
+void vram_step(void)
 {
-    unsigned char i, c;
-    unsigned char tile;
+    unsigned char r, c, n;
+    unsigned char *src;
     unsigned int adr;
 
-    tile = (phase & 1) ? TILE_EMPTY : TILE_BLOCK;
+    hud_update();
+
+    /* During a line clear: flash tiles, then flash attributes. The board is
+     * collapsed in place ahead of time, so rows are only redrawn from the
+     * final field once the clear is published. */
+    if (pl->state == STATE_LINECLEAR) {
+        n = pl->num_lines_clearing;
+        while (pl->flash_row < n && vbuf_room() >= PF_W) {
+            adr = PF_NTADR(0, pl->lines_to_clear[pl->flash_row]);
+            for (c = 0; c < PF_W; ++c) {
+                vbuf_put(adr + c, TILE_FLASH);
+            }
+            ++pl->flash_row;
+        }
+        while (pl->flash_row == n && pl->flash_attr < n
+               && vbuf_room() >= ATTR_ROW_BYTES) {
+            /* Quadrants the previous clear left on the flash palette go
+             * back first, so only this clear's rows flash */
+            if (!pl->flash_attr && pl->flash_qrows) {
+                flash_restore_qrow();
+            } else {
+                flash_attr_line(pl->flash_attr);
+                ++pl->flash_attr;
+            }
+        }
+        return;
+    }
 
-    for (i = 0; i < num_lines_clearing; ++i) {
-        adr = PF_NTADR(0, lines_to_clear[i]);
+    r = pl->redraw_row;
+    while (r < pl->redraw_end && vbuf_room() >= PF_W) {
+        adr = PF_NTADR(0, r);
+        src = playfield + row_ofs[r];
         for (c = 0; c < PF_W; ++c) {
-            vbuf_put(adr + c, tile);
+            vbuf_put(adr + c, src[c] ? TILE_BLOCK : TILE_EMPTY);
         }
+        ++r;
     }
-}
+    pl->redraw_row = r;
 
-/* Full playfield redraw after line collapse (rendering off) */
-void redraw_playfield_full(void)
-{
-    ppu_off();
-    draw_playfield();
-    scroll(0, 0);
-    ppu_on_all();
+    /* Flash quadrants go back to palette 0 once no flash tile is left */
+    if (r >= pl->redraw_end) {
+        while (pl->flash_qrows && vbuf_room() >= ATTR_ROW_BYTES) {
+            flash_restore_qrow();
+        }
+    }
 }
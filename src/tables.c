@@ -0,0 +1,16 @@
+/* tables.c - Precomputed lookup tables (tools/tables_gen.py)
+ *
+ * Everything here goes in the TABLES segment: the fixed PRG bank on NROM,
+ * switchable bank BANK_TABLES on UNROM builds, where tables can grow
+ * without crowding code. Read them only after tables_use().
+ */
+
+#include "neslib.h"
+#include "tetris.h"
+#include "tables.h"
+
+#pragma rodata-name (push, "TABLES")
+
+const unsigned char score_bcd[MAX_LEVEL + 1][4][3] = SCORE_BCD;
+
+#pragma rodata-name (pop)
@@ -58,74 +58,107 @@ const unsigned char piece_pal[] = {
     0,  /* L - orange (use pal 0) */
 };
 
-/* Speed table: frames per gravity drop, indexed by level (0-29) */
-const unsigned char speed_table[] = {
+/* Speed tables: frames per gravity drop, indexed by level (0-29).
+ * The 50 Hz table (PAL, Dendy) is the NTSC one scaled by 5/6, rounded,
+ * so pieces fall at the same real-time speed.
+ */
+static const unsigned char speed_ntsc[GRAV_LEVEL] = {
     48, 43, 38, 33, 28, 23, 18, 13, 8, 6,  /* levels 0-9 */
      5,  5,  5,  4,  4,  4,  3,  3,  3, 2,  /* levels 10-19 */
      2,  2,  2,  2,  2,  2,  2,  2,  2, 1,  /* levels 20-29 */
 };
+static const unsigned char speed_50hz[GRAV_LEVEL] = {
+    40, 36, 32, 28, 23, 19, 15, 11, 7, 5,  /* levels 0-9 */
+     4,  4,  4,  3,  3,  3,  3,  3,  3, 2,  /* levels 10-19 */
+     2,  2,  2,  2,  2,  2,  2,  2,  2, 1,  /* levels 20-29 */
+};
+
+/* Gravity tables: 8.8 fixed-point rows per frame for levels 30-39, from
+ * 1.5G to 20G. The 50 Hz table is the NTSC one scaled by 6/5.
+ */
+static const unsigned int gravity_ntsc[MAX_LEVEL - GRAV_LEVEL + 1] = {
+    384, 512, 768, 1024, 1536, 2048, 2560, 3072, 4096, GRAV_20G,
+};
+static const unsigned int gravity_50hz[MAX_LEVEL - GRAV_LEVEL + 1] = {
+    461, 614, 922, 1229, 1843, 2458, 3072, 3686, 4915, GRAV_20G,
+};
+
+/* Region frame timings (region_init) */
+const unsigned char *speed_table;
+const unsigned int *gravity_table;
+unsigned char das_delay;
+unsigned char das_repeat;
+unsigned char lineclear_frames;
+unsigned char lock_delay;
+
+/* MAX_LEVEL in BCD, and the binary value of a BCD level's tens digit */
+#define MAX_LEVEL_BCD (((MAX_LEVEL / 10) << 4) | (MAX_LEVEL % 10))
+static const unsigned char level_tens[MAX_LEVEL / 10 + 1] = {
+    0, 10, 20, 30,
+};
+
+/* Board tables, specialized for the board geometry */
+const unsigned char row_ofs[PF_H] = BOARD_ROW_OFS;
+const unsigned int pf_nt_row[PF_H] = BOARD_NT_ROW;
+
+/* Byte % PF_W without division, for garbage hole columns: the high
+ * nibble is folded first (16 * hi % PF_W), then the sum with the low one */
+static const unsigned char mod_w_hi[16] = BOARD_MOD_W_HI;
+static const unsigned char mod_w_fold[PF_W + 15] = BOARD_MOD_W_FOLD;
+
+/* Screen layouts: single player, versus player 1, versus player 2 */
+const unsigned char layout_pf_x[NUM_LAYOUTS]  = { PF_X,  VS_PF_X0,  VS_PF_X1 };
+const unsigned char layout_hud_x[NUM_LAYOUTS] = { HUD_X, VS_HUD_X,  VS_HUD_X };
+const unsigned char layout_hud_y[NUM_LAYOUTS] = { HUD_Y, VS_HUD_Y0, VS_HUD_Y1 };
+
+/* Garbage rows sent to the opponent per lines cleared (versus) */
+static const unsigned char garbage_sent[] = { 0, 0, 1, 2, 4 };
 
 /* ── Game state variables ── */
-unsigned char playfield[PF_H * PF_W];
+player_t players[MAX_PLAYERS];
+unsigned char playfields[MAX_PLAYERS][PF_H * PF_W];
+unsigned char num_players;
+unsigned char loser;
+
+#pragma bss-name (push, "ZEROPAGE")
+player_t *pl;
+unsigned char *playfield;
+unsigned char col_piece;
+unsigned char col_rot;
+signed char col_x;
+signed char col_y;
+#pragma bss-name (pop)
+
 unsigned char game_state;
-unsigned char cur_piece;
-unsigned char cur_rot;
-signed char cur_x;
-signed char cur_y;
-unsigned char next_piece;
-unsigned char level;
-unsigned char drop_timer;
-unsigned char lineclear_timer;
-unsigned char lines_to_clear[4];
-unsigned char num_lines_clearing;
-
-unsigned char score[3];
-unsigned char lines[2];
-
-unsigned char pad_cur;
-unsigned char pad_prev;
-unsigned char pad_new;
-
-unsigned char das_dir;
-unsigned char das_timer;
-
-unsigned int rng_seed;
-
-/* ── RNG: 16-bit Galois LFSR ── */
-static unsigned char raw_random(void)
-{
-    unsigned char bit;
-    bit = (unsigned char)(rng_seed & 1);
-    rng_seed >>= 1;
-    if (bit)
-        rng_seed ^= 0xB400;
-    return (unsigned char)(rng_seed & 0xFF);
-}
 
-unsigned char next_random_piece(void)
+/* ── Switch the game core to player n ── */
+void player_select(unsigned char n)
 {
-    unsigned char p;
-    p = raw_random() % NUM_PIECES;
-    /* Re-roll once if same as current (reduces repeats) */
-    if (p == cur_piece)
-        p = raw_random() % NUM_PIECES;
-    return p;
+    if (n) {
+        pl = &players[1];
+        playfield = playfields[1];
+    } else {
+        pl = &players[0];
+        playfield = playfields[0];
+    }
 }
 
+#ifndef ASM_KERNELS
+
 /* ── Collision detection ──
- * Returns 1 if piece at (x,y) with given rotation collides, 0 if OK
+ * Returns 1 if piece col_piece at (col_x,col_y) with rotation col_rot
+ * collides, 0 if OK. See kernels.s for the assembly version.
  */
-unsigned char check_collision(unsigned char piece, unsigned char rot,
-                              signed char x, signed char y)
+unsigned char __fastcall__ check_collision(void)
 {
     unsigned char i, idx;
     signed char bx, by;
 
-    idx = (piece << 4) | (rot << 2);
+    idx = (col_piece << 4) | (col_rot << 2);
 
     for (i = 0; i < 4; ++i) {
-        bx = x + (signed char)piece_x[idx + i];
-        by = y + (signed char)piece_y[idx + i];
+        bx = col_x + (signed char)piece_x[idx + i];
+        by = col_y + (signed char)piece_y[idx + i];
 
         /* Wall/floor bounds */
         if (bx < 0 || bx >= PF_W || by >= PF_H)
@@ -136,25 +169,25 @@ unsigned char check_collision(unsigned char piece, unsigned char rot,
             continue;
 
         /* Check playfield */
-        if (playfield[(unsigned char)by * PF_W + (unsigned char)bx])
+        if (playfield[row_ofs[by] + (unsigned char)bx])
             return 1;
     }
     return 0;
 }
 
 /* ── Lock the current piece into the playfield ── */
-void lock_piece(void)
+void __fastcall__ lock_piece(void)
 {
     unsigned char i, idx, bx, by;
 
-    idx = (unsigned char)(cur_piece << 4) | (unsigned char)(cur_rot << 2);
+    idx = (unsigned char)(pl->cur_piece << 4) | (unsigned char)(pl->cur_rot << 2);
 
     for (i = 0; i < 4; ++i) {
-        bx = (unsigned char)((signed char)piece_x[idx + i] + cur_x);
-        by = (unsigned char)((signed char)piece_y[idx + i] + cur_y);
+        bx = (unsigned char)((signed char)piece_x[idx + i] + pl->cur_x);
+        by = (unsigned char)((signed char)piece_y[idx + i] + pl->cur_y);
 
         if (by < PF_H && bx < PF_W) {
-            playfield[by * PF_W + bx] = cur_piece + 1; /* nonzero = filled */
+            playfield[row_ofs[by] + bx] = pl->cur_piece + 1; /* nonzero = filled */
 
             /* Queue VRAM update for this cell */
             vbuf_put(PF_NTADR(bx, by), TILE_BLOCK);
@@ -162,244 +195,475 @@ void lock_piece(void)
     }
 }
 
+#endif /* ASM_KERNELS */
+
 /* ── Check for completed lines ──
  * Returns number of completed lines (0-4), fills lines_to_clear[]
  */
 unsigned char check_lines(void)
 {
-    unsigned char r, c, full, count;
+    register unsigned char *row;
+    unsigned char r, count;
 
     count = 0;
-    for (r = 0; r < PF_H; ++r) {
-        full = 1;
-        for (c = 0; c < PF_W; ++c) {
-            if (!playfield[r * PF_W + c]) {
-                full = 0;
-                break;
-            }
-        }
-        if (full) {
-            lines_to_clear[count] = r;
+    row = playfield;
+    for (r = 0; r < PF_H; ++r, row += PF_W) {
+        if (ROW_FULL(row)) {
+            pl->lines_to_clear[count] = r;
             ++count;
             if (count >= 4) break;
         }
     }
-    num_lines_clearing = count;
+    pl->num_lines_clearing = count;
     return count;
 }
 
-/* ── Collapse cleared lines ── */
-void collapse_lines(void)
+/* ── Collapse the i-th cleared line, counting up from the bottom one ──
+ * Lines are collapsed bottom first; the i lines already collapsed below
+ * this one have each pulled it down a row. lines_to_clear[] is left as is
+ * for the flash.
+ */
+void collapse_line(unsigned char i)
 {
-    unsigned char i, r, c, dst;
-
-    /* Process from bottom line to top */
-    for (i = num_lines_clearing; i > 0; --i) {
-        dst = lines_to_clear[i - 1];
-        /* Shift everything above down by one */
-        for (r = dst; r > 0; --r) {
-            for (c = 0; c < PF_W; ++c) {
-                playfield[r * PF_W + c] = playfield[(r - 1) * PF_W + c];
-            }
-        }
-        /* Clear top row */
+    register unsigned char *row;
+    unsigned char r, dst;
+
+    dst = pl->lines_to_clear[pl->num_lines_clearing - 1 - i] + i;
+    /* Shift everything above down by one */
+    row = playfield + row_ofs[dst];
+    for (r = dst; r > 0; --r) {
+        ROW_COPY(row, row - PF_W);
+        row -= PF_W;
+    }
+    /* Clear top row */
+    ROW_CLEAR(playfield);
+}
+
+/* ── Push pending garbage rows in from the bottom (versus) ──
+ * Each garbage row is full except for one random hole column.
+ */
+void push_garbage(void)
+{
+    register unsigned char *dst;
+    unsigned char n, r, c, hole, shift;
+
+    n = pl->garbage_in;
+    if (!n)
+        return;
+    pl->garbage_in = 0;
+
+    /* Shift the stack up by n rows; anything pushed off the top is lost */
+    shift = row_ofs[n];
+    dst = playfield;
+    for (r = n; r < PF_H; ++r) {
+        ROW_COPY(dst, dst + shift);
+        dst += PF_W;
+    }
+
+    /* Fill the bottom n rows */
+    for (r = 0; r < n; ++r) {
+        hole = rand_byte();
+        hole = mod_w_fold[mod_w_hi[hole >> 4] + (hole & 0x0F)];
         for (c = 0; c < PF_W; ++c) {
-            playfield[c] = 0;
-        }
-        /* Adjust remaining line indices (they shifted down) */
-        {
-            unsigned char j;
-            for (j = 0; j < i - 1; ++j) {
-                if (lines_to_clear[j] < dst)
-                    ++lines_to_clear[j];
-            }
+            dst[c] = (c == hole) ? 0 : CELL_GARBAGE;
         }
+        dst += PF_W;
     }
-}
 
+    /* The whole stack moved */
+    redraw_rows(0, PF_H);
+}
 /* ── BCD addition helper ──
- * Add a 16-bit value to 3-byte BCD score
- * NES doesn't have decimal mode, so we do it manually
+ * Add the n-byte BCD number val to bcd (most significant byte first; score
+ * 3 bytes, lines 2), saturating at all nines. NES doesn't have decimal
+ * mode, so we do it a digit at a time
  */
-static void bcd_add(unsigned char *bcd, unsigned long val)
+static void bcd_add(unsigned char *bcd, const unsigned char *val, unsigned char n)
 {
-    unsigned long current;
-    unsigned long result;
-    unsigned char d;
-    unsigned char i;
-
-    /* Convert BCD to binary */
-    current = 0;
-    for (i = 0; i < 3; ++i) {
-        current = current * 100UL + (unsigned long)((bcd[i] >> 4) * 10 + (bcd[i] & 0x0F));
+    unsigned char i, lo, hi, c;
+
+    c = 0;
+    for (i = n; i > 0; --i) {
+        lo = (bcd[i - 1] & 0x0F) + (val[i - 1] & 0x0F) + c;
+        c = lo > 9;
+        if (c) lo -= 10;
+        hi = (bcd[i - 1] >> 4) + (val[i - 1] >> 4) + c;
+        c = hi > 9;
+        if (c) hi -= 10;
+        bcd[i - 1] = (unsigned char)(hi << 4) | lo;
     }
 
-    result = current + val;
-    if (result > 999999UL) result = 999999UL;
-
-    /* Convert back to BCD */
-    for (i = 3; i > 0; --i) {
-        d = (unsigned char)(result % 100UL);
-        bcd[i - 1] = (unsigned char)(((d / 10) << 4) | (d % 10));
-        result /= 100UL;
+    if (c) {
+        for (i = 0; i < n; ++i)
+            bcd[i] = 0x99;
     }
 }
 
-/* ── Add score for cleared lines ── */
+/* ── Add score for cleared lines (1-4) ── */
 void add_score(unsigned char num_lines)
 {
-    static const unsigned int points[] = { 0, 40, 100, 300, 1200 };
-    unsigned long pts;
+    unsigned char cleared[2];
 
-    pts = (unsigned long)points[num_lines] * (unsigned long)(level + 1);
-    bcd_add(score, pts);
+    /* Points from the precomputed per-level table */
+    tables_use();
+    bcd_add(pl->score, score_bcd[pl->level][num_lines - 1], 3);
 
     /* Add to line counter (BCD) */
-    bcd_add(lines, (unsigned long)num_lines);
-
-    /* Level up every 10 lines: convert lines BCD to binary */
-    {
-        unsigned int total_lines;
-        total_lines = (unsigned int)((lines[0] >> 4) * 10 + (lines[0] & 0x0F)) * 100
-                    + (unsigned int)((lines[1] >> 4) * 10 + (lines[1] & 0x0F));
-        level = (unsigned char)(total_lines / 10);
-        if (level > 29) level = 29;
+    cleared[0] = 0;
+    cleared[1] = num_lines;
+    bcd_add(pl->lines, cleared, 2);
+
+    /* Level up every 10 lines: the level is the lines' hundreds and tens
+     * digits, taken straight from the BCD, up to MAX_LEVEL */
+    if (pl->lines[0] > 0x09) {
+        pl->level_bcd = MAX_LEVEL_BCD;
+    } else {
+        pl->level_bcd = (unsigned char)(pl->lines[0] << 4) | (pl->lines[1] >> 4);
+        if (pl->level_bcd > MAX_LEVEL_BCD)
+            pl->level_bcd = MAX_LEVEL_BCD;
     }
+    pl->level = level_tens[pl->level_bcd >> 4] + (pl->level_bcd & 0x0F);
 }
 
 /* ── Spawn a new piece ── */
 void spawn_piece(void)
 {
-    cur_piece = next_piece;
-    next_piece = next_random_piece();
-    cur_rot = 0;
-    cur_x = 3;
-    cur_y = -1; /* Start partially above screen */
+    push_garbage();
+    spawn_next(next_random_piece());
+}
+
+/* ── Bring the preview piece into play, with next as the new preview ── */
+void spawn_next(unsigned char next)
+{
+    pl->cur_piece = pl->next_piece;
+    pl->next_piece = next;
+    pl->cur_rot = 0;
+    pl->cur_x = SPAWN_X;
+    pl->cur_y = -1; /* Start partially above screen */
+    pl->grav_frac = 0;
+    pl->lock_timer = 0;
 
     /* If spawn position collides, game over */
-    if (check_collision(cur_piece, cur_rot, cur_x, cur_y + 1)) {
+    if (COLLIDES(pl->cur_piece, pl->cur_rot, pl->cur_x, pl->cur_y + 1)) {
         game_state = STATE_GAMEOVER;
-        lineclear_timer = 0;
+        loser = pl->idx;
+        pl->lineclear_timer = 0;
         hide_sprites();
     }
 }
 
-/* ── Gravity: drop piece by one row ── */
-void do_gravity(void)
+/* ── Rows the active piece can fall before landing, at most max ──
+ * Scans each column of the board down from the piece's lowest block in
+ * that column, instead of testing the whole piece once per row.
+ */
+unsigned char drop_distance(unsigned char max)
 {
-    unsigned char spd;
-    spd = (level < 30) ? speed_table[level] : 1;
+    register unsigned char *cell;
+    signed char low[4];
+    signed char by;
+    unsigned char i, base, c, d;
+
+    low[0] = low[1] = low[2] = low[3] = -1;
+    base = (pl->cur_piece << 4) + (pl->cur_rot << 2);
+    for (i = base; i < base + 4; ++i) {
+        c = piece_x[i];
+        if ((signed char)piece_y[i] > low[c])
+            low[c] = piece_y[i];
+    }
+
+    for (c = 0; c < 4 && max; ++c) {
+        if (low[c] < 0)
+            continue;
+        by = pl->cur_y + low[c] + 1;
+        d = 0;
+        /* Rows above the board are always free */
+        while (by < 0 && d < max) {
+            ++by;
+            ++d;
+        }
+        if (d < max && by < PF_H) {
+            cell = playfield + row_ofs[by] + (unsigned char)(pl->cur_x + c);
+            while (d < max && !*cell) {
+                ++d;
+                if (++by >= PF_H)
+                    break;
+                cell += PF_W;
+            }
+        }
+        max = d;
+    }
+    return max;
+}
 
-    ++drop_timer;
-    if (drop_timer < spd)
+/* Lock the active piece, then line clear or spawn the next one */
+static void lock_and_next(void)
+{
+    TRACE_EV(EV_LOCK);
+    lock_piece();
+    TRACE_EV(EV_LINES);
+    if (check_lines()) {
+        pl->state = STATE_LINECLEAR;
+        pl->lineclear_timer = 0;
+        pl->clear_step = 0;
+        /* Flash tiles and attributes are queued by vram_step() */
+        pl->flash_row = 0;
+        pl->flash_attr = 0;
+        flash_phase(0);
+        hide_sprites();
+    } else {
+        /* No lines: score is unchanged, only the preview needs updating */
+        spawn_piece();
+        draw_next_piece();
+    }
+}
+
+/* ── Gravity ──
+ * Below GRAV_LEVEL: drop one row every speed_table[level] frames and lock
+ * on the first tick that cannot move. From GRAV_LEVEL: fall the whole
+ * rows of an 8.8 accumulator every frame, landing through
+ * drop_distance(), and lock after lock_delay frames on the ground.
+ */
+void do_gravity(void)
+{
+    unsigned int acc;
+    unsigned char rows;
+
+    if (pl->level < GRAV_LEVEL) {
+        ++pl->drop_timer;
+        if (pl->drop_timer < speed_table[pl->level])
+            return;
+        pl->drop_timer = 0;
+
+        if (!COLLIDES(pl->cur_piece, pl->cur_rot, pl->cur_x, pl->cur_y + 1))
+            ++pl->cur_y;
+        else
+            lock_and_next();
         return;
-    drop_timer = 0;
+    }
+
+    acc = gravity_table[pl->level - GRAV_LEVEL] + pl->grav_frac;
+    pl->grav_frac = (unsigned char)acc;
+    rows = (unsigned char)(acc >> 8);
+    if (rows)
+        pl->cur_y += drop_distance(rows);
 
-    if (!check_collision(cur_piece, cur_rot, cur_x, cur_y + 1)) {
-        ++cur_y;
+    if (drop_distance(1)) {
+        pl->lock_timer = 0;
+    } else if (pl->lock_timer >= lock_delay) {
+        lock_and_next();
     } else {
-        /* Lock piece */
-        lock_piece();
-        if (check_lines()) {
-            game_state = STATE_LINECLEAR;
-            lineclear_timer = 0;
-            hide_sprites();
-        } else {
-            spawn_piece();
-            draw_next_piece();
-            draw_score();
+        ++pl->lock_timer;
+    }
+}
+
+/* ── One step of the post-clear work, staged during the animation ──
+ * Score, each line's collapse, garbage out, garbage in and the next piece
+ * pick are done one per frame. Nothing becomes visible until the clear
+ * is published: the HUD is not marked dirty and vram_step() holds back
+ * row redraws while the board is in STATE_LINECLEAR.
+ */
+static void lineclear_step(void)
+{
+    unsigned char s, n;
+
+    s = pl->clear_step;
+    ++pl->clear_step;
+    n = pl->num_lines_clearing;
+
+    if (s == 0) {
+        TRACE_EV(EV_SCORE);
+        add_score(n);
+    } else if (s <= n) {
+        collapse_line(s - 1);
+    } else if (s == n + 1) {
+        /* Versus: multi-line clears send garbage to the opponent */
+        if (num_players > 1) {
+            player_t *opp;
+            opp = &players[pl->idx ^ 1];
+            opp->garbage_in += garbage_sent[n];
+            if (opp->garbage_in > GARBAGE_MAX)
+                opp->garbage_in = GARBAGE_MAX;
         }
+    } else if (s == n + 2) {
+        push_garbage();
+    } else {
+        pl->staged_next = next_random_piece();
+    }
+}
+
+/* ── Line clear animation, then publish the staged post-clear state ── */
+void do_lineclear(void)
+{
+    unsigned char n;
+
+    ++pl->lineclear_timer;
+    /* Flash every 4 frames: only a palette color changes */
+    if ((pl->lineclear_timer & 3) == 0)
+        flash_phase(pl->lineclear_timer >> 2);
+
+    n = pl->num_lines_clearing;
+    if (pl->lineclear_timer < lineclear_frames) {
+        if (pl->clear_step < LINECLEAR_STEPS(n))
+            lineclear_step();
+        return;
+    }
+
+    /* Only left over if the animation is shorter than the steps */
+    while (pl->clear_step < LINECLEAR_STEPS(n))
+        lineclear_step();
+
+    /* Flash tiles left until the redraw reaches them look empty */
+    flash_phase(FLASH_OFF);
+    /* Rows below the lowest cleared line did not move */
+    redraw_rows(0, pl->lines_to_clear[n - 1] + 1);
+    pl->hud_dirty = 1;
+    spawn_next(pl->staged_next);
+    draw_next_piece();
+    pl->state = STATE_PLAYING;
+}
+
+/* ── Select the frame timings for the detected region ── */
+void region_init(void)
+{
+    if (region == REGION_NTSC) {
+        speed_table = speed_ntsc;
+        gravity_table = gravity_ntsc;
+        das_delay = 16;
+        das_repeat = 6;
+        lineclear_frames = 20;
+        lock_delay = 30;
+    } else {
+        /* PAL and Dendy both run at 50 Hz */
+        speed_table = speed_50hz;
+        gravity_table = gravity_50hz;
+        das_delay = 13;
+        das_repeat = 5;
+        lineclear_frames = 17;
+        lock_delay = 25;
     }
 }
 
+/* ── Poll the active player's controller ── */
+void read_pad(void)
+{
+    pl->pad_prev = pl->pad_cur;
+    pl->pad_cur = pad_poll(pl->port);
+    pl->pad_new = pl->pad_cur & ~pl->pad_prev;
+}
+
 /* ── Input handling with DAS ── */
 void do_input(void)
 {
     unsigned char new_rot;
     signed char new_x;
 
-    pad_prev = pad_cur;
-    pad_cur = pad_poll(0);
-    pad_new = pad_cur & ~pad_prev;
+    read_pad();
 
-    /* Tick RNG on every input poll */
-    raw_random();
+    /* Tick RNG (and the bag shuffle) on every input poll */
+    rand_tick();
 
     /* Rotate: A = clockwise, B = counter-clockwise */
-    if (pad_new & PAD_A) {
-        new_rot = (cur_rot + 1) & 3;
-        if (!check_collision(cur_piece, new_rot, cur_x, cur_y))
-            cur_rot = new_rot;
+    if (pl->pad_new & PAD_A) {
+        new_rot = (pl->cur_rot + 1) & 3;
+        if (!COLLIDES(pl->cur_piece, new_rot, pl->cur_x, pl->cur_y))
+            pl->cur_rot = new_rot;
     }
-    if (pad_new & PAD_B) {
-        new_rot = (cur_rot + 3) & 3; /* -1 mod 4 */
-        if (!check_collision(cur_piece, new_rot, cur_x, cur_y))
-            cur_rot = new_rot;
+    if (pl->pad_new & PAD_B) {
+        new_rot = (pl->cur_rot + 3) & 3; /* -1 mod 4 */
+        if (!COLLIDES(pl->cur_piece, new_rot, pl->cur_x, pl->cur_y))
+            pl->cur_rot = new_rot;
     }
 
     /* Left/Right with DAS */
-    if (pad_new & PAD_LEFT) {
-        if (!check_collision(cur_piece, cur_rot, cur_x - 1, cur_y))
-            --cur_x;
-        das_dir = PAD_LEFT;
-        das_timer = 0;
-    } else if (pad_new & PAD_RIGHT) {
-        if (!check_collision(cur_piece, cur_rot, cur_x + 1, cur_y))
-            ++cur_x;
-        das_dir = PAD_RIGHT;
-        das_timer = 0;
-    } else if (pad_cur & das_dir) {
-        ++das_timer;
-        if (das_timer >= DAS_DELAY) {
-            das_timer = DAS_DELAY - DAS_REPEAT;
-            new_x = cur_x + ((das_dir == PAD_LEFT) ? -1 : 1);
-            if (!check_collision(cur_piece, cur_rot, new_x, cur_y))
-                cur_x = new_x;
+    if (pl->pad_new & PAD_LEFT) {
+        if (!COLLIDES(pl->cur_piece, pl->cur_rot, pl->cur_x - 1, pl->cur_y))
+            --pl->cur_x;
+        pl->das_dir = PAD_LEFT;
+        pl->das_timer = 0;
+    } else if (pl->pad_new & PAD_RIGHT) {
+        if (!COLLIDES(pl->cur_piece, pl->cur_rot, pl->cur_x + 1, pl->cur_y))
+            ++pl->cur_x;
+        pl->das_dir = PAD_RIGHT;
+        pl->das_timer = 0;
+    } else if (pl->pad_cur & pl->das_dir) {
+        ++pl->das_timer;
+        if (pl->das_timer >= das_delay) {
+            pl->das_timer = das_delay - das_repeat;
+            new_x = pl->cur_x + ((pl->das_dir == PAD_LEFT) ? -1 : 1);
+            if (!COLLIDES(pl->cur_piece, pl->cur_rot, new_x, pl->cur_y))
+                pl->cur_x = new_x;
         }
     } else {
-        das_dir = 0;
-        das_timer = 0;
+        pl->das_dir = 0;
+        pl->das_timer = 0;
     }
 
     /* Soft drop: Down */
-    if (pad_cur & PAD_DOWN) {
-        if (!check_collision(cur_piece, cur_rot, cur_x, cur_y + 1)) {
-            ++cur_y;
-            drop_timer = 0;
+    if (pl->pad_cur & PAD_DOWN) {
+        if (!COLLIDES(pl->cur_piece, pl->cur_rot, pl->cur_x, pl->cur_y + 1)) {
+            ++pl->cur_y;
+            pl->drop_timer = 0;
         }
     }
 
     /* Hard drop: Up */
-    if (pad_new & PAD_UP) {
-        while (!check_collision(cur_piece, cur_rot, cur_x, cur_y + 1))
-            ++cur_y;
-        drop_timer = 255; /* Force immediate lock on next gravity tick */
+    if (pl->pad_new & PAD_UP) {
+        pl->cur_y += drop_distance(PF_H);
+        /* Force immediate lock on next gravity tick (the increment must
+         * not wrap drop_timer to 0) */
+        pl->drop_timer = 254;
+        pl->lock_timer = 255;
     }
 }
 
-/* ── Initialize game state ── */
-void start_game(void)
+/* ── Initialize game state for 1 or 2 players ── */
+void start_game(unsigned char players_count)
 {
+    unsigned char n, k;
     unsigned int i;
 
-    /* Clear playfield */
-    for (i = 0; i < PF_H * PF_W; ++i)
-        playfield[i] = 0;
-
-    /* Reset score/lines/level */
-    score[0] = 0; score[1] = 0; score[2] = 0;
-    lines[0] = 0; lines[1] = 0;
-    level = 0;
-    drop_timer = 0;
-    das_dir = 0;
-    das_timer = 0;
+    num_players = players_count;
 
     /* Seed RNG (use whatever is in nmi_flag count from title screen) */
     if (rng_seed == 0) rng_seed = 0x1234;
 
-    /* Pick first two pieces */
-    next_piece = next_random_piece();
-    spawn_piece();
-
-    game_state = STATE_PLAYING;
+    for (n = 0; n < players_count; ++n) {
+        player_select(n);
+
+        /* Clear playfield */
+        for (i = 0; i < PF_H * PF_W; ++i)
+            playfield[i] = 0;
+
+        /* Reset score/lines/level */
+        pl->score[0] = 0; pl->score[1] = 0; pl->score[2] = 0;
+        pl->lines[0] = 0; pl->lines[1] = 0;
+        pl->level = 0;
+        pl->level_bcd = 0;
+        pl->drop_timer = 0;
+        pl->das_dir = 0;
+        pl->das_timer = 0;
+        pl->garbage_in = 0;
+        pl->flash_row = 0;
+        pl->flash_attr = 0;
+        pl->flash_qrows = 0;
+        pl->redraw_row = 0;
+        pl->redraw_end = 0;
+        pl->cur_piece = 0;
+
+        /* Layout */
+        pl->idx = n;
+        pl->port = n;
+        pl->oam = n << 4;
+        k = LAYOUT(n, players_count);
+        pl->pf_x = layout_pf_x[k];
+        pl->hud_x = layout_hud_x[k];
+        pl->hud_y = layout_hud_y[k];
+
+        /* Pick first two pieces; the first has nothing to re-roll against */
+        rand_init();
+        pl->next_piece = NUM_PIECES;
+        pl->next_piece = next_random_piece();
+        spawn_piece();
+        pl->state = STATE_PLAYING;
+    }
 }
@@ -3,22 +3,46 @@
 #ifndef _TETRIS_H
 #define _TETRIS_H
 
-/* Playfield dimensions */
-#define PF_W    10
-#define PF_H    20
+/* Playfield dimensions PF_W x PF_H, top row PF_Y, and the tables and
+ * unrolled row macros specialized for them. Generated per board variant
+ * by tools/board_gen.py (BOARD in the Makefile).
+ */
+#include "board.h"
 
-/* Playfield position on nametable (top-left of inner area) */
+/* Playfield column on nametable (left of inner area), single player */
 #define PF_X    3
-#define PF_Y    2
 
-/* Nametable address for playfield cell */
-#define PF_NTADR(col,row) NTADR_A((col)+PF_X, (row)+PF_Y)
+/* Versus mode board columns: player 1 on the left edge, player 2 on the
+ * right. The HUD between them only fits up to 10-column boards. */
+#if PF_W <= 10
+#define VS_ENABLED
+#endif
+#define VS_PF_X0  1
+#define VS_PF_X1  (31 - PF_W)
 
-/* Game states */
+/* Spawn column: 4-wide piece box centered on the board */
+#define SPAWN_X ((PF_W - 4) / 2)
+
+/* Nametables (vertical mirroring keeps two): the title screen lives in A
+ * and the game screen in B, so either can be built through the VRAM queue
+ * while the other is shown */
+#define NT_TITLE 0
+#define NT_GAME  1
+#define GAME_NTADR(x,y) NTADR_B(x,y)
+#define GAME_ATADR(i)   ATADR_B(i)
+
+/* Nametable address for a cell of the active player's playfield */
+#define PF_NTADR(col,row) (pf_nt_row[row] + pl->pf_x + (col))
+
+/* Game states (game_state); a player's own state is PLAYING or LINECLEAR */
 #define STATE_TITLE     0
 #define STATE_PLAYING   1
 #define STATE_LINECLEAR 2
 #define STATE_GAMEOVER  3
+#define STATE_BUILD     4   /* game screen being built off-screen */
+
+/* Players */
+#define MAX_PLAYERS 2
 
 /* Piece types */
 #define PIECE_I  0
@@ -30,22 +54,95 @@
 #define PIECE_L  6
 #define NUM_PIECES 7
 
-/* DAS (Delayed Auto Shift) timings in frames */
-#define DAS_DELAY   16
-#define DAS_REPEAT  6
+/* Randomizer modes (rand_mode) */
+#define RAND_CLASSIC 0
+#define RAND_BAG     1
+#define RAND_HISTORY 2
+#define NUM_RAND_MODES 3
+
+/* Frame timings for the detected region (region_init): DAS (Delayed Auto
+ * Shift) delay and repeat, line clear animation length, and the lock
+ * delay at fixed-point gravity levels. 50 Hz regions use shorter counts
+ * so the game runs at NTSC real-time speed.
+ */
+extern unsigned char das_delay;
+extern unsigned char das_repeat;
+extern unsigned char lineclear_frames;
+extern unsigned char lock_delay;
+
+/* Levels below GRAV_LEVEL use the frame-exact speed_table (frames per
+ * row, lock on the first blocked drop), up to the 1G kill screen at 29;
+ * from GRAV_LEVEL up to MAX_LEVEL gravity is 8.8 fixed-point rows per
+ * frame from gravity_table, up to 20G (GRAV_20G: land at once), with a
+ * lock delay.
+ */
+#define GRAV_LEVEL 30
+#define MAX_LEVEL  39
+#define GRAV_20G   (20 << 8)
+
+/* Post-clear steps staged during a line clear of n lines: score, one
+ * collapse per line, garbage out, garbage in, next piece */
+#define LINECLEAR_STEPS(n) ((n) + 4)
+
+/* Garbage rows received by the opponent are capped at this many pending */
+#define GARBAGE_MAX  12
+/* Playfield cell value for garbage blocks (pieces use 1..NUM_PIECES) */
+#define CELL_GARBAGE 8
+
+/* HUD origin on nametable: single player, and the two stacked versus HUDs */
+#define HUD_X     (PF_X + PF_W + 3)
+#define HUD_Y     1
+#define VS_HUD_X  13
+#define VS_HUD_Y0 1
+#define VS_HUD_Y1 15
 
-/* Line clear animation frames */
-#define LINECLEAR_FRAMES 20
+/* Layout slot of player n in a count-player game: single player, or
+ * versus player 1 or 2 (layout_pf_x[] and friends) */
+#define LAYOUT(n,count) ((count) > 1 ? (n) + 1 : 0)
+#define NUM_LAYOUTS 3
 
-/* Score display position on nametable */
-#define SCORE_X  16
-#define SCORE_Y  1
-#define LINES_X  16
-#define LINES_Y  4
-#define LEVEL_X  16
-#define LEVEL_Y  7
-#define NEXT_X   17
-#define NEXT_Y   10
+/* HUD element positions, relative to the player's HUD origin */
+#define SCORE_DX 0
+#define SCORE_DY 0
+#define LINES_DX 0
+#define LINES_DY 3
+#define LEVEL_DX 0
+#define LEVEL_DY 6
+#define NEXT_DX  1
+#define NEXT_DY  9
+
+/* Digits shown by all HUD widgets (hud.c): score 6, lines 4, level 2 */
+#define HUD_DIGITS 12
+
+/* Line-clear flash: BG palette reserved per player, the phase that turns
+ * the flash off, and attribute bytes covering one board row at most */
+#define FLASH_PAL(idx)  (3 - (idx))
+#define FLASH_OFF       7
+#define ATTR_ROW_BYTES  ((PF_W + 3) / 4 + 1)
+
+/* Trace event markers (TRACE builds, see TRACE_EV in neslib.h and
+ * tools/trace2chrome.py). EV_VBUF carries the queued entry count in its
+ * low 7 bits, in the same write, so an NMI cannot split the two.
+ */
+#define EV_FRAME     0x01
+#define EV_INPUT     0x02
+#define EV_GRAVITY   0x03
+#define EV_LOCK      0x04
+#define EV_LINES     0x05
+#define EV_SCORE     0x06
+#define EV_VRAM      0x07
+#define EV_VBUF      0x80
+#define EV_IDLE      0x09
+#define EV_NMI_IN    0x0A
+#define EV_NMI_OUT   0x0B
+#define EV_LINECLEAR 0x0C
+
+/* Title screen mode select label ("SELECT: 1 PLAYER") */
+#define TITLE_MODE_X 8
+#define TITLE_MODE_Y 20
+/* Title screen randomizer label ("RANDOM: CLASSIC") */
+#define TITLE_RAND_X 8
+#define TITLE_RAND_Y 22
 
 /* Piece data tables (112 bytes each): piece*16 + rot*4 + block */
 extern const unsigned char piece_x[];
@@ -54,66 +151,179 @@ extern const unsigned char piece_y[];
 /* Sprite palette index per piece type (0-3) */
 extern const unsigned char piece_pal[];
 
-/* Speed table: frames per drop for each level */
-extern const unsigned char speed_table[];
+/* Row start offsets into playfield[] and nametable row addresses (board.h) */
+extern const unsigned char row_ofs[PF_H];
+extern const unsigned int pf_nt_row[PF_H];
+
+/* Board column, HUD column and HUD row of each layout slot (LAYOUT) */
+extern const unsigned char layout_pf_x[NUM_LAYOUTS];
+extern const unsigned char layout_hud_x[NUM_LAYOUTS];
+extern const unsigned char layout_hud_y[NUM_LAYOUTS];
+
+/* Precomputed lookup tables (tables.c): in the TABLES segment, which is
+ * PRG bank BANK_TABLES on UNROM builds. Call tables_use() before reading
+ * them; the bank stays mapped until something else is switched in.
+ */
+#define BANK_TABLES 1
+#define tables_use() bank_use(BANK_TABLES)
+
+/* Points for clearing 1-4 lines at each level, 3 bytes BCD */
+extern const unsigned char score_bcd[MAX_LEVEL + 1][4][3];
+
+/* Speed table for the detected region: frames per drop for each level
+ * below GRAV_LEVEL, and 8.8 rows per frame for GRAV_LEVEL..MAX_LEVEL */
+extern const unsigned char *speed_table;
+extern const unsigned int *gravity_table;
+
+/* Per-player game state. The game core always works on the active player
+ * through the zero-page pointer pl (and its board through playfield);
+ * player_select() switches both.
+ */
+typedef struct {
+    /* Fields read by kernels.s come first: keep its PL_* offsets in sync */
+    unsigned char cur_piece;
+    unsigned char cur_rot;
+    signed char cur_x;
+    signed char cur_y;
+    unsigned char pf_x;         /* board column on nametable */
+    unsigned char oam;          /* offset of this player's 4 sprites in OAM */
 
-/* Playfield state: PF_W * PF_H bytes, 0=empty, nonzero=filled */
-extern unsigned char playfield[PF_H * PF_W];
+    unsigned char state;        /* STATE_PLAYING or STATE_LINECLEAR */
+    unsigned char next_piece;
+    unsigned char level;
+    unsigned char drop_timer;
+    unsigned char grav_frac;    /* fixed-point gravity: fraction of a row */
+    unsigned char lock_timer;   /* fixed-point gravity: frames on the ground */
+    unsigned char lineclear_timer;
+    unsigned char clear_step;   /* post-clear work staged so far (do_lineclear) */
+    unsigned char staged_next;  /* next piece picked during the line clear */
+    unsigned char lines_to_clear[4];
+    unsigned char num_lines_clearing;
 
-/* Game state variables */
+    /* Score: 3 bytes BCD (6 digits) */
+    unsigned char score[3];
+    /* Lines: 2 bytes BCD (4 digits) */
+    unsigned char lines[2];
+    /* Level: 1 byte BCD (2 digits), for the HUD */
+    unsigned char level_bcd;
+
+    /* Input state */
+    unsigned char pad_cur;
+    unsigned char pad_prev;
+    unsigned char pad_new;
+
+    /* DAS state */
+    unsigned char das_dir;
+    unsigned char das_timer;
+
+    /* Versus: garbage rows waiting to be pushed in on the next spawn */
+    unsigned char garbage_in;
+
+    /* Randomizer state (random.c) */
+    unsigned char bag[NUM_PIECES];      /* 7-bag being dealt, from bag_pos */
+    unsigned char bag_pos;
+    unsigned char sb_piece[NUM_PIECES]; /* next bag, shuffled one piece per frame */
+    unsigned char sb_key[NUM_PIECES];
+    unsigned char sb_n;
+    unsigned char hist[4];              /* history mode: last 4 pieces */
+
+    /* Line-clear flash: cleared rows with flash tiles queued, cleared
+     * lines whose attributes are done, and a bit per attribute quadrant
+     * row still on the flash palette (render.c) */
+    unsigned char flash_row;
+    unsigned char flash_attr;
+    unsigned int flash_qrows;
+
+    /* Playfield rows [redraw_row, redraw_end) still to be queued to VRAM */
+    unsigned char redraw_row;
+    unsigned char redraw_end;
+
+    /* HUD digit tiles on screen, and whether a shown value changed (hud.c) */
+    unsigned char hud_shadow[HUD_DIGITS];
+    unsigned char hud_dirty;
+
+    /* Fixed per-player layout */
+    unsigned char idx;          /* player number (0 or 1) */
+    unsigned char port;         /* controller port */
+    unsigned char hud_x;        /* HUD origin on nametable */
+    unsigned char hud_y;
+} player_t;
+
+extern player_t players[MAX_PLAYERS];
+extern unsigned char playfields[MAX_PLAYERS][PF_H * PF_W];
+
+/* Active player and its playfield (PF_W * PF_H bytes, 0=empty, nonzero=filled) */
+extern player_t *pl;
+#pragma zpsym("pl")
+extern unsigned char *playfield;
+#pragma zpsym("playfield")
+
+/* check_collision() arguments, passed in zero page */
+extern unsigned char col_piece;
+#pragma zpsym("col_piece")
+extern unsigned char col_rot;
+#pragma zpsym("col_rot")
+extern signed char col_x;
+#pragma zpsym("col_x")
+extern signed char col_y;
+#pragma zpsym("col_y")
+
+/* Collision test of piece p, rotation r at (x,y): 1 if blocked */
+#define COLLIDES(p,r,x,y) \
+    (col_piece = (p), col_rot = (r), col_x = (x), col_y = (y), check_collision())
+
+/* Global game state */
 extern unsigned char game_state;
-extern unsigned char cur_piece;
-extern unsigned char cur_rot;
-extern signed char cur_x;
-extern signed char cur_y;
-extern unsigned char next_piece;
-extern unsigned char level;
-extern unsigned char drop_timer;
-extern unsigned char lineclear_timer;
-extern unsigned char lines_to_clear[4];
-extern unsigned char num_lines_clearing;
-
-/* Score: 3 bytes BCD (6 digits) */
-extern unsigned char score[3];
-/* Lines: 2 bytes BCD (4 digits) */
-extern unsigned char lines[2];
-
-/* Input state */
-extern unsigned char pad_cur;
-extern unsigned char pad_prev;
-extern unsigned char pad_new;
-
-/* DAS state */
-extern unsigned char das_dir;
-extern unsigned char das_timer;
-
-/* RNG seed */
+extern unsigned char num_players;
+extern unsigned char loser;
+
+/* RNG seed and randomizer mode (RAND_*) */
 extern unsigned int rng_seed;
+extern unsigned char rand_mode;
 
 /* ── tetris.c functions ── */
-void start_game(void);
-unsigned char check_collision(unsigned char piece, unsigned char rot,
-                              signed char x, signed char y);
-void lock_piece(void);
+void region_init(void);
+void player_select(unsigned char n);
+void start_game(unsigned char players_count);
+void read_pad(void);
+/* Hot-path kernels: C versions here, or kernels.s when built with ASM_KERNELS */
+unsigned char __fastcall__ check_collision(void);
+void __fastcall__ lock_piece(void);
 unsigned char check_lines(void);
-void collapse_lines(void);
+void collapse_line(unsigned char i);
 void add_score(unsigned char num_lines);
 void spawn_piece(void);
-unsigned char next_random_piece(void);
+void spawn_next(unsigned char next);
+unsigned char drop_distance(unsigned char max);
 void do_gravity(void);
 void do_input(void);
+void do_lineclear(void);
+void push_garbage(void);
+
+/* ── random.c functions ── */
+unsigned char rand_byte(void);
+void rand_init(void);
+void rand_tick(void);
+unsigned char next_random_piece(void);
 
 /* ── render.c functions ── */
 void vbuf_put(unsigned int adr, unsigned char tile);
-void update_sprites(void);
+void vbuf_str(unsigned int adr, const char *s);
+void __fastcall__ update_sprites(void);
 void hide_sprites(void);
-void draw_playfield(void);
-void draw_border(void);
-void draw_hud_labels(void);
-void draw_score(void);
 void draw_next_piece(void);
 void draw_title_screen(void);
-void flash_lines(unsigned char phase);
-void redraw_playfield_full(void);
+void draw_title_mode(unsigned char players_count);
+void draw_title_rand(void);
+void clear_screen(void);
+void build_begin(void);
+unsigned char build_step(void);
+void flash_phase(unsigned char phase);
+void redraw_rows(unsigned char from, unsigned char to);
+void vram_step(void);
+
+/* ── hud.c functions ── */
+void hud_reset(void);
+void hud_update(void);
 
 #endif /* _TETRIS_H */
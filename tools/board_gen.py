@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Generate board.h: playfield geometry and the per-geometry tables/macros
+the game core is specialized with (row offsets, nametable row addresses,
+modulo-width fold tables, fully unrolled row tests and row copies).
+
+Usage: board_gen.py <width> <height> <top-row> <output>
+"""
+
+import sys
+import os
+
+
+def generate_board(width, height, top, output_path):
+    """Write board.h for a width x height playfield starting at nametable row top."""
+    if width * height > 256:
+        sys.exit(f"board_gen: {width}x{height} board exceeds 256 cells (8-bit playfield index)")
+    if top < 1 or top + height > 29:
+        sys.exit(f"board_gen: {height} rows at row {top} do not fit the nametable with borders")
+
+    cells = range(width)
+    row_ofs = ', '.join(str(r * width) for r in range(height))
+    nt_rows = ', '.join(f"0x{0x2400 + (r + top) * 32:04X}" for r in range(height))
+    mod_hi = ', '.join(str(h * 16 % width) for h in range(16))
+    mod_fold = ', '.join(str(v % width) for v in range(width + 15))
+
+    lines = [
+        f"/* board.h - {width}x{height} playfield geometry and tables",
+        " * Generated by tools/board_gen.py; do not edit.",
+        " */",
+        "",
+        "#ifndef _BOARD_H",
+        "#define _BOARD_H",
+        "",
+        f"#define PF_W    {width}",
+        f"#define PF_H    {height}",
+        f"#define PF_Y    {top}",
+        "",
+        "/* Row start offsets into playfield[]: r * PF_W */",
+        f"#define BOARD_ROW_OFS {{ {row_ofs} }}",
+        "",
+        "/* Game nametable (B) address of column 0 of each row: NTADR_B(0, r + PF_Y) */",
+        f"#define BOARD_NT_ROW {{ {nt_rows} }}",
+        "",
+        "/* b % PF_W without division: BOARD_MOD_W_FOLD[BOARD_MOD_W_HI[b >> 4] + (b & 15)] */",
+        f"#define BOARD_MOD_W_HI {{ {mod_hi} }}",
+        f"#define BOARD_MOD_W_FOLD {{ {mod_fold} }}",
+        "",
+        "/* Nonzero if every cell of the row at p is filled */",
+        "#define ROW_FULL(p) (" + ' && '.join(f"(p)[{c}]" for c in cells) + ")",
+        "",
+        "/* Clear the row at p */",
+        "#define ROW_CLEAR(p) do { " + ' '.join(f"(p)[{c}] = 0;" for c in cells) + " } while (0)",
+        "",
+        "/* Copy the row at s to d */",
+        "#define ROW_COPY(d,s) do { " + ' '.join(f"(d)[{c}] = (s)[{c}];" for c in cells) + " } while (0)",
+        "",
+        "#endif /* _BOARD_H */",
+        "",
+    ]
+
+    os.makedirs(os.path.dirname(output_path) or '.', exist_ok=True)
+    with open(output_path, 'w') as f:
+        f.write('\n'.join(lines))
+
+    print(f"Generated {output_path} ({width}x{height} board at row {top})")
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 5:
+        sys.exit(__doc__)
+    generate_board(int(sys.argv[1]), int(sys.argv[2]), int(sys.argv[3]), sys.argv[4])
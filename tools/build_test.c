@@ -0,0 +1,146 @@
+/* build_test.c - Host test for the off-screen game screen builder (make test)
+ *
+ * Runs build_begin()/build_step() frame by frame and applies each frame's
+ * VRAM queue to a copy of both nametables, as the NMI would. For every
+ * region's budget it checks that:
+ *   - no frame queues more entries than the budget
+ *   - nothing is written outside the game nametable (the title stays up)
+ *   - a build finishes within MAX_FRAMES frames
+ *   - a screen built over another layout, or over line-clear flash
+ *     attributes left behind, comes out the same as one built over the
+ *     same layout: no stale tiles or attributes survive
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "neslib.h"
+#include "tetris.h"
+
+#define MAX_FRAMES 120
+#define NT_SIZE    0x400
+
+/* Nametables A (title) and B (game), from $2000 */
+static unsigned char vram[2 * NT_SIZE];
+static unsigned char stray;
+static unsigned int frames, worst;
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    printf("%s  %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok)
+        ++failures;
+}
+
+/* The NMI's drain: apply the frame's queue, then empty it */
+static void nmi(void)
+{
+    unsigned char i;
+    unsigned int adr;
+
+    if (vbuf_len > vbuf_budget)
+        ++stray;
+    for (i = 0; i < vbuf_len; ++i) {
+        adr = (vram_buf[i * 3] << 8) | vram_buf[i * 3 + 1];
+        if (adr < 0x2400 || adr >= 0x2800)
+            ++stray;
+        else
+            vram[adr - 0x2000] = vram_buf[i * 3 + 2];
+    }
+    vbuf_len = 0;
+}
+
+/* Build a game screen for n players, as main() does from the title */
+static void build(unsigned char n)
+{
+    unsigned int f;
+
+    rng_seed = 0x1234;      /* the same preview piece every time */
+    game_state = STATE_BUILD;
+    start_game(n);
+    build_begin();
+    for (f = 1; f <= MAX_FRAMES; ++f) {
+        if (build_step())
+            break;
+        nmi();
+    }
+    nmi();
+    frames = f;
+    if (f > worst)
+        worst = f;
+}
+
+/* Leave the active player's bottom rows on the flash palette, as a game
+ * that ended during a line clear does */
+static void leave_flash(void)
+{
+    unsigned char f;
+
+    player_select(0);
+    pl->lines_to_clear[0] = PF_H - 4;
+    pl->lines_to_clear[1] = PF_H - 1;
+    pl->num_lines_clearing = 2;
+    pl->state = STATE_LINECLEAR;
+    pl->flash_row = 0;
+    pl->flash_attr = 0;
+    for (f = 0; f < 10 && pl->flash_attr < 2; ++f) {
+        vram_step();
+        nmi();
+    }
+}
+
+static void test_budget(unsigned char budget)
+{
+    static unsigned char one[NT_SIZE], two[NT_SIZE];
+    unsigned char *game;
+    char what[120];
+    int ok;
+
+    vbuf_budget = budget;
+    stray = 0;
+    worst = 0;
+    game = vram + NT_SIZE;
+    memset(vram, TILE_BLANK, sizeof vram);
+
+    /* Over a blank nametable, then over the other layout */
+    build(1);
+    memcpy(one, game, NT_SIZE);
+    build(2);
+    memcpy(two, game, NT_SIZE);
+
+    build(2);
+    ok = !memcmp(two, game, NT_SIZE);
+    snprintf(what, sizeof what, "budget %u: versus over versus matches versus over 1 player", budget);
+    check(ok, what);
+
+    build(1);
+    ok = !memcmp(one, game, NT_SIZE);
+    snprintf(what, sizeof what, "budget %u: 1 player over versus matches 1 player over blank", budget);
+    check(ok, what);
+
+    build(1);
+    leave_flash();
+    ok = memcmp(one, game, NT_SIZE) != 0;
+    build(1);
+    ok = ok && !memcmp(one, game, NT_SIZE);
+    snprintf(what, sizeof what, "budget %u: flash attributes left behind are cleared", budget);
+    check(ok, what);
+
+    snprintf(what, sizeof what, "budget %u: within budget and nametable B, worst %u frames",
+             budget, worst);
+    check(!stray && worst <= MAX_FRAMES, what);
+}
+
+int main(void)
+{
+    test_budget(42);    /* NTSC, Dendy */
+    test_budget(60);    /* EXT_VBLANK */
+    test_budget(84);    /* PAL */
+
+    if (failures) {
+        printf("build_test: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("build_test: all checks passed\n");
+    return 0;
+}
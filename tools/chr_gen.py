@@ -113,9 +113,15 @@ GAME_TILES = {
     0x60: {'p0': [0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00],
            'p1': [0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00]},
 
-    # Block ($61, tile index 65): highlighted block with border - color 3 (both planes)
-    0x61: {'p0': [0xFF,0x81,0xBD,0xBD,0xBD,0xBD,0x81,0xFF],
-           'p1': [0xFF,0xFF,0xC3,0xC3,0xC3,0xC3,0xFF,0xFF]},
+    # Block ($61, tile index 65): color 2 fill with a color 3 border.
+    # Color 1 is left to the line-clear flash tile.
+    0x61: {'p0': [0xFF,0x81,0x81,0x81,0x81,0x81,0x81,0xFF],
+           'p1': [0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF]},
+
+    # Line-clear flash ($62, tile index 66): solid color 1, colored through
+    # the flash palette
+    0x62: {'p0': [0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF],
+           'p1': [0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00]},
 
     # Border top-left corner ($68, tile index 72)
     0x68: {'p0': [0x00,0x00,0x0F,0x08,0x08,0x08,0x08,0x08],
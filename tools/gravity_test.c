@@ -0,0 +1,134 @@
+/* gravity_test.c - Host test for frame-counted gravity (make test)
+ *
+ * Levels below GRAV_LEVEL must fall and lock exactly as before the
+ * fixed-point gravity levels were added: one row every speed_table[level]
+ * frames, and a lock on the first drop tick that cannot move, with no lock
+ * delay. Here that rule, with the speed tables of that time (levels 0-29),
+ * is the reference. For both frame rates, every such level and piece, over
+ * random stacks and starting drop timers, do_gravity() must lock on the
+ * same frame at the same row.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "neslib.h"
+#include "tetris.h"
+
+#define BOARDS 64
+#define MAX_FRAMES 2000
+
+/* Frames per row before fixed-point gravity, levels 0-29 */
+static const unsigned char old_ntsc[30] = {
+    48, 43, 38, 33, 28, 23, 18, 13, 8, 6,
+     5,  5,  5,  4,  4,  4,  3,  3,  3, 2,
+     2,  2,  2,  2,  2,  2,  2,  2,  2, 1,
+};
+static const unsigned char old_50hz[30] = {
+    40, 36, 32, 28, 23, 19, 15, 11, 7, 5,
+     4,  4,  4,  3,  3,  3,  3,  3,  3, 2,
+     2,  2,  2,  2,  2,  2,  2,  2,  2, 1,
+};
+
+static unsigned char board[PF_H * PF_W];
+static unsigned long cases, failed;
+
+/* A random stack up to 12 rows high, a hole or two in each row */
+static void make_board(void)
+{
+    unsigned char r, c, top;
+
+    memset(board, 0, sizeof board);
+    top = (unsigned char)(PF_H - rand() % 13);
+    for (r = top; r < PF_H; ++r)
+        for (c = 0; c < PF_W; ++c)
+            board[row_ofs[r] + c] = (rand() % 8) ? CELL_GARBAGE : 0;
+}
+
+/* The old rule: frames until the lock, and the row it locks on */
+static unsigned int old_lock(const unsigned char *speed, signed char *y)
+{
+    unsigned char t;
+    unsigned int f;
+
+    t = pl->drop_timer;
+    *y = pl->cur_y;
+    for (f = 1; f <= MAX_FRAMES; ++f) {
+        if (++t < speed[pl->level])
+            continue;
+        t = 0;
+        if (COLLIDES(pl->cur_piece, pl->cur_rot, pl->cur_x, *y + 1))
+            return f;
+        ++*y;
+    }
+    return 0;
+}
+
+static void test_case(const unsigned char *speed, unsigned char level, unsigned char p)
+{
+    signed char want_y, y;
+    unsigned int want, f;
+
+    memcpy(playfield, board, sizeof board);
+    pl->level = level;
+    pl->cur_piece = p;
+    pl->cur_rot = 0;
+    pl->cur_x = SPAWN_X;
+    pl->cur_y = -1;
+    pl->state = STATE_PLAYING;
+    pl->drop_timer = (unsigned char)(rand() % speed[level]);
+    pl->grav_frac = 0;
+    pl->lock_timer = 0;
+    if (COLLIDES(p, 0, SPAWN_X, -1))
+        return;
+
+    want = old_lock(speed, &want_y);
+
+    /* The lock is the frame lock_piece() writes the board */
+    for (f = 1; f <= MAX_FRAMES; ++f) {
+        y = pl->cur_y;
+        vbuf_len = 0;
+        do_gravity();
+        if (memcmp(playfield, board, sizeof board))
+            break;
+    }
+
+    ++cases;
+    if (f != want || y != want_y) {
+        if (++failed <= 10)
+            printf("FAIL  level %u piece %u: locked on frame %u at row %d, expected %u at %d\n",
+                   level, p, f, y, want, want_y);
+    }
+}
+
+int main(void)
+{
+    static const unsigned char regions[2] = { REGION_NTSC, REGION_PAL };
+    unsigned char r, level, p;
+    unsigned int n;
+
+    srand(1);
+    game_state = STATE_PLAYING;
+    start_game(1);
+    player_select(0);
+
+    for (r = 0; r < 2; ++r) {
+        region = regions[r];
+        region_init();
+        for (n = 0; n < BOARDS; ++n) {
+            make_board();
+            for (level = 0; level < 30; ++level)
+                for (p = 0; p < NUM_PIECES; ++p)
+                    test_case(r ? old_50hz : old_ntsc, level, p);
+        }
+    }
+
+    printf("%s  levels 0-29 lock on the same frame as before: %lu of %lu cases\n",
+           failed ? "FAIL" : "ok  ", cases - failed, cases);
+    if (failed) {
+        printf("gravity_test: %lu case(s) differ\n", failed);
+        return 1;
+    }
+    printf("gravity_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,46 @@
+/* host_neslib.c - Stand-in neslib and crt0 state for native host builds
+ *
+ * The host tests (make test) and tools/stress.py compile the game sources
+ * with the system C compiler, C kernels included, and link them with this
+ * file instead of crt0.s and neslib.s. PPU calls do nothing; hosts that
+ * run the main loop define their own ppu_wait_nmi() and pad_poll(), and
+ * tools/stress_host.c its own palette calls, which is why those are weak
+ * here.
+ */
+
+#include "neslib.h"
+
+/* ── crt0 state ── */
+unsigned char oam_buf[256];
+unsigned char vram_buf[VBUF_CAP * 3];
+unsigned char vbuf_len;
+unsigned char vbuf_budget = 42;
+unsigned char region;
+
+/* ── neslib ── */
+__attribute__((weak)) void ppu_wait_nmi(void)
+{
+    vbuf_len = 0;
+}
+
+__attribute__((weak)) unsigned char pad_poll(unsigned char pad)
+{
+    (void)pad;
+    return 0;
+}
+
+void ppu_on_bg(void) {}
+void ppu_on_spr(void) {}
+void ppu_on_all(void) {}
+void ppu_off(void) {}
+void ppu_nt(unsigned char nt) { (void)nt; }
+void ppu_mask(unsigned char mask) { (void)mask; }
+void vram_adr(unsigned int adr) { (void)adr; }
+void vram_put(unsigned char val) { (void)val; }
+void vram_write(const unsigned char *data, unsigned int len) { (void)data; (void)len; }
+void vram_fill(unsigned char val, unsigned int len) { (void)val; (void)len; }
+__attribute__((weak)) void pal_all(const unsigned char *data) { (void)data; }
+__attribute__((weak)) void pal_bg(const unsigned char *data) { (void)data; }
+__attribute__((weak)) void pal_spr(const unsigned char *data) { (void)data; }
+__attribute__((weak)) void pal_col(unsigned char index, unsigned char color) { (void)index; (void)color; }
+void scroll(unsigned int x, unsigned int y) { (void)x; (void)y; }
@@ -0,0 +1,223 @@
+/* kernel_test.c - Host test: kernels.s against the C kernels (make test)
+ *
+ * kernels.s is assembled and linked on its own (cfg/kernel_test.cfg, with
+ * tools/kernel_test.s putting the symbols it imports at fixed addresses)
+ * and run in a 6502 simulator (sim6502.c). The C kernels in tetris.c and
+ * render.c are the reference. Over a corpus of random boards, for every
+ * piece, rotation and position (x from -3 to PF_W, y from -2 to PF_H):
+ *   check_collision  the same result
+ *   lock_piece       the same board cells and VRAM queue
+ *   update_sprites   the same OAM bytes
+ * It also prints each asm kernel's worst cycle count.
+ *
+ * Usage: kernel_test [kernels.bin], by default next to the executable
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "neslib.h"
+#include "tetris.h"
+#include "sim6502.h"
+
+#define BOARDS 32
+
+/* Simulated memory (must match kernel_test.s) */
+#define SIM_PL          0x80
+#define SIM_PLAYFIELD   0x82
+#define SIM_VBUF_LEN    0x84
+#define SIM_COL_PIECE   0x85
+#define SIM_COL_ROT     0x86
+#define SIM_COL_X       0x87
+#define SIM_COL_Y       0x88
+#define SIM_PIECE_X     0x0200
+#define SIM_PIECE_Y     0x0280
+#define SIM_PIECE_PAL   0x0300
+#define SIM_OAM_BUF     0x0400
+#define SIM_VRAM_BUF    0x0500
+#define SIM_PLAYER      0x0600
+#define SIM_BOARD       0x0700
+#define SIM_ROM         0x8000
+
+/* Entry points (jump table in kernel_test.s) */
+#define K_CHECK_COLLISION   0x8000
+#define K_LOCK_PIECE        0x8003
+#define K_UPDATE_SPRITES    0x8006
+
+/* Fields kernels.s reads from player_t (its PL_* offsets) */
+#define PL_HEAD 6
+
+static cpu6502_t cpu;
+static unsigned char board[PF_H * PF_W];
+static unsigned long worst[3];
+static unsigned long cases[3], failed[3];
+static const char *const kernel_name[3] = { "check_collision", "lock_piece", "update_sprites" };
+
+/* ── Load the linked kernels.s image at $8000 ── */
+static void load_image(const char *path)
+{
+    FILE *f;
+    size_t n;
+
+    f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        exit(2);
+    }
+    n = fread(cpu.mem + SIM_ROM, 1, 0x10000 - SIM_ROM, f);
+    fclose(f);
+    if (!n) {
+        fprintf(stderr, "%s: empty image\n", path);
+        exit(2);
+    }
+}
+
+/* Run the asm kernel k at adr; returns 0 if it crashed */
+static int run(unsigned char k, unsigned int adr)
+{
+    unsigned long cycles;
+
+    sim_reset(&cpu);
+    cycles = sim_call(&cpu, adr, 10000);
+    if (!cycles)
+        return 0;
+    if (cycles > worst[k])
+        worst[k] = cycles;
+    return 1;
+}
+
+static void fail(unsigned char k, const char *what, signed char x, signed char y)
+{
+    if (++failed[k] <= 10)
+        printf("FAIL  %s: %s, piece %u rot %u at %d,%d\n", kernel_name[k], what,
+               pl->cur_piece, pl->cur_rot, x, y);
+}
+
+/* ── Set the same state on both sides ── */
+static void setup(signed char x, signed char y, unsigned char p, unsigned char r)
+{
+    pl->cur_piece = p;
+    pl->cur_rot = r;
+    pl->cur_x = x;
+    pl->cur_y = y;
+    memcpy(playfield, board, sizeof board);
+    memcpy(cpu.mem + SIM_BOARD, board, sizeof board);
+    /* The head of player_t byte for byte, as kernels.s sees it */
+    memcpy(cpu.mem + SIM_PLAYER, pl, PL_HEAD);
+
+    /* The output buffers hold the board's garbage, partly queued */
+    memcpy(cpu.mem + SIM_VRAM_BUF, vram_buf, sizeof vram_buf);
+    memcpy(cpu.mem + SIM_OAM_BUF, oam_buf, sizeof oam_buf);
+    vbuf_len = cpu.mem[SIM_VBUF_LEN] = (unsigned char)(rand() % (VBUF_CAP - 3));
+}
+
+static void test_position(signed char x, signed char y, unsigned char p, unsigned char r)
+{
+    unsigned char c;
+
+    /* check_collision */
+    setup(x, y, p, r);
+    col_piece = cpu.mem[SIM_COL_PIECE] = p;
+    col_rot = cpu.mem[SIM_COL_ROT] = r;
+    col_x = x;
+    col_y = y;
+    cpu.mem[SIM_COL_X] = (unsigned char)x;
+    cpu.mem[SIM_COL_Y] = (unsigned char)y;
+    c = check_collision();
+    ++cases[0];
+    if (!run(0, K_CHECK_COLLISION))
+        fail(0, "crashed", x, y);
+    else if (cpu.a != c || cpu.x != 0)
+        fail(0, "different result", x, y);
+
+    /* lock_piece */
+    setup(x, y, p, r);
+    lock_piece();
+    ++cases[1];
+    if (!run(1, K_LOCK_PIECE))
+        fail(1, "crashed", x, y);
+    else if (memcmp(playfield, cpu.mem + SIM_BOARD, sizeof board))
+        fail(1, "different board", x, y);
+    else if (vbuf_len != cpu.mem[SIM_VBUF_LEN]
+             || memcmp(vram_buf, cpu.mem + SIM_VRAM_BUF, sizeof vram_buf))
+        fail(1, "different VRAM queue", x, y);
+
+    /* update_sprites */
+    setup(x, y, p, r);
+    update_sprites();
+    ++cases[2];
+    if (!run(2, K_UPDATE_SPRITES))
+        fail(2, "crashed", x, y);
+    else if (memcmp(oam_buf, cpu.mem + SIM_OAM_BUF, sizeof oam_buf))
+        fail(2, "different OAM", x, y);
+}
+
+/* Board n of the corpus: empty, full, then random fill levels; and new
+ * garbage in the output buffers */
+static void make_board(unsigned int n)
+{
+    unsigned int i, fill;
+
+    fill = n == 0 ? 0 : n == 1 ? 100 : (unsigned int)(rand() % 101);
+    for (i = 0; i < sizeof board; ++i)
+        board[i] = (unsigned int)(rand() % 100) < fill ? (unsigned char)(1 + rand() % CELL_GARBAGE) : 0;
+    for (i = 0; i < sizeof vram_buf; ++i)
+        vram_buf[i] = (unsigned char)rand();
+    for (i = 0; i < sizeof oam_buf; ++i)
+        oam_buf[i] = (unsigned char)rand();
+}
+
+int main(int argc, char **argv)
+{
+    static char path[1024];
+    unsigned int n, total;
+    unsigned char p, r, k;
+    signed char x, y;
+    const char *slash;
+
+    if (argc > 1) {
+        snprintf(path, sizeof path, "%s", argv[1]);
+    } else {
+        slash = strrchr(argv[0], '/');
+        snprintf(path, sizeof path, "%.*skernels.bin",
+                 slash ? (int)(slash - argv[0] + 1) : 0, argv[0]);
+    }
+    load_image(path);
+
+    /* Tables and pointers the kernels import */
+    memcpy(cpu.mem + SIM_PIECE_X, piece_x, NUM_PIECES * 16);
+    memcpy(cpu.mem + SIM_PIECE_Y, piece_y, NUM_PIECES * 16);
+    memcpy(cpu.mem + SIM_PIECE_PAL, piece_pal, NUM_PIECES);
+    cpu.mem[SIM_PL] = SIM_PLAYER & 0xFF;
+    cpu.mem[SIM_PL + 1] = SIM_PLAYER >> 8;
+    cpu.mem[SIM_PLAYFIELD] = SIM_BOARD & 0xFF;
+    cpu.mem[SIM_PLAYFIELD + 1] = SIM_BOARD >> 8;
+
+    srand(1);
+    player_select(0);
+    for (n = 0; n < BOARDS; ++n) {
+        make_board(n);
+        /* Every layout's board column and OAM slot */
+        pl->pf_x = layout_pf_x[n % NUM_LAYOUTS];
+        pl->oam = (n & 1) << 4;
+        for (p = 0; p < NUM_PIECES; ++p)
+            for (r = 0; r < 4; ++r)
+                for (y = -2; y <= PF_H; ++y)
+                    for (x = -3; x <= PF_W; ++x)
+                        test_position(x, y, p, r);
+    }
+
+    total = 0;
+    for (k = 0; k < 3; ++k) {
+        printf("%s  %s: %lu of %lu cases match, worst %lu cycles\n",
+               failed[k] ? "FAIL" : "ok  ", kernel_name[k],
+               cases[k] - failed[k], cases[k], worst[k]);
+        total += failed[k] != 0;
+    }
+    if (total) {
+        printf("kernel_test: %u kernel(s) differ from the C versions\n", total);
+        return 1;
+    }
+    printf("kernel_test: all checks passed\n");
+    return 0;
+}
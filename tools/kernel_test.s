@@ -0,0 +1,34 @@
+; kernel_test.s - Link stub for the kernel test (tools/kernel_test.c)
+; Puts the symbols kernels.s imports at the fixed addresses the test's
+; 6502 simulator uses, and a jump table to the kernels at $8000.
+
+.exportzp _pl, _playfield, _vbuf_len
+.exportzp _col_piece, _col_rot, _col_x, _col_y
+.export _piece_x, _piece_y, _piece_pal
+.export _vram_buf, _oam_buf
+.import _check_collision, _lock_piece, _update_sprites
+
+; ────────────────────────────────────────────────
+; Simulated memory (must match kernel_test.c)
+; ────────────────────────────────────────────────
+_pl        = $80        ; -> player head at $0600
+_playfield = $82        ; -> board at $0700
+_vbuf_len  = $84
+_col_piece = $85
+_col_rot   = $86
+_col_x     = $87
+_col_y     = $88
+
+_piece_x   = $0200
+_piece_y   = $0280
+_piece_pal = $0300
+_oam_buf   = $0400
+_vram_buf  = $0500
+
+; ────────────────────────────────────────────────
+; Entry points: $8000, $8003, $8006
+; ────────────────────────────────────────────────
+.segment "ENTRY"
+    jmp _check_collision
+    jmp _lock_piece
+    jmp _update_sprites
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Report CPU RAM use from the ld65 map file.
+
+Work RAM at $0300-$07FF holds BSS and DATA from the bottom and the cc65 C
+stack, __STACK_SIZE__ bytes, at the top (cfg/*.cfg); ld65 refuses to link
+if BSS and DATA grow into the stack. This prints zero page and RAM use,
+the headroom left, and the modules that take the most RAM.
+
+Usage: ram_report.py build/nessy.map
+"""
+
+import re
+import sys
+
+ZP_SIZE = 0xF0          # $10-$FF, as in the linker configs
+RAM_START = 0x0300
+RAM_END = 0x0800
+RAM_SEGMENTS = ('BSS', 'DATA')
+
+SECTIONS = ('Modules list', 'Segment list', 'Exports list by name',
+            'Exports list by value', 'Imports list')
+SEGMENT_RE = re.compile(r'^(\w+)\s+([0-9A-F]{6})\s+([0-9A-F]{6})\s+([0-9A-F]{6})\s+[0-9A-F]{5}$')
+MODULE_SEG_RE = re.compile(r'^\s+(\w+)\s+Offs=[0-9A-F]+\s+Size=([0-9A-F]+)')
+EXPORT_RE = re.compile(r'(\w+)\s+([0-9A-F]{6})\s+[A-Z]{2,3}\b')
+
+
+def read_map(path):
+    """Return ({segment: size}, {module: {segment: size}}, {export: value})
+    from an ld65 map file."""
+    segments, modules, exports = {}, {}, {}
+    section = module = None
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip()
+            if line in (s + ':' for s in SECTIONS):
+                section = line[:-1]
+                continue
+            if section == 'Modules list':
+                if line.endswith(':') and not line.startswith(' '):
+                    module = line[:-1]
+                    continue
+                m = MODULE_SEG_RE.match(line)
+                if m and module:
+                    sizes = modules.setdefault(module, {})
+                    sizes[m.group(1)] = sizes.get(m.group(1), 0) + int(m.group(2), 16)
+            elif section == 'Segment list':
+                m = SEGMENT_RE.match(line)
+                if m:
+                    segments[m.group(1)] = int(m.group(4), 16)
+            elif section and section.startswith('Exports list'):
+                for m in EXPORT_RE.finditer(line):
+                    exports[m.group(1)] = int(m.group(2), 16)
+    return segments, modules, exports
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    segments, modules, exports = read_map(sys.argv[1])
+    if not segments:
+        sys.exit(f'{sys.argv[1]}: no segment list (is this an ld65 map file?)')
+
+    stack = exports.get('__STACK_SIZE__', 0x80)
+    ram = RAM_END - stack - RAM_START
+    used = sum(segments.get(s, 0) for s in RAM_SEGMENTS)
+
+    print(f'RAM use ({sys.argv[1]})')
+    print(f'  zero page  {segments.get("ZEROPAGE", 0):4d} / {ZP_SIZE} bytes')
+    print(f'  RAM        {used:4d} / {ram} bytes (BSS, DATA) at ${RAM_START:04X},'
+          f' {ram - used} free')
+    print(f'  C stack    {stack:4d} bytes below ${RAM_END:04X}')
+    users = sorted(((sum(s.get(seg, 0) for seg in RAM_SEGMENTS), name)
+                    for name, s in modules.items()), reverse=True)
+    for size, name in users:
+        if size:
+            print(f'    {name:28s} {size:4d}')
+
+
+if __name__ == '__main__':
+    main()
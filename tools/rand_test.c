@@ -0,0 +1,295 @@
+/* rand_test.c - Host test for the piece randomizer (make test)
+ *
+ * Runs random.c together with the game core's spawn path over millions of
+ * draws and checks each mode against its specification:
+ *   classic  picks are MOD7 of an LFSR byte (pieces 0-3 come up 37 times
+ *            in 256, pieces 4-6 36 times), re-rolled once when equal to
+ *            the piece they follow
+ *   7-bag    every 7 pieces are a permutation, each piece as likely in
+ *            every position, whether the shuffle was spread over frames or
+ *            completed on the spot in bag_refill()
+ *   history  a pick is in the last 4 only if all 4 rolls were, and that
+ *            fallback is as frequent as 4 independent rolls make it
+ * Frequencies must be within 5 standard errors of the expected values.
+ * The frame gaps between pieces come from the host's rand(); an optional
+ * argument seeds it.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "neslib.h"
+#include "tetris.h"
+
+#define DRAWS 2000000L
+#define BAGS  100000L
+
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    printf("%s  %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok)
+        ++failures;
+}
+
+/* Observed count against expected probability p over n trials */
+static int within(double count, double p, double n)
+{
+    return fabs(count - p * n) <= 5.0 * sqrt(n * p * (1.0 - p));
+}
+
+/* Chance a single roll is piece p: MOD7 of a uniform byte */
+static double roll_p(unsigned char p)
+{
+    return p < 4 ? 37.0 / 256.0 : 36.0 / 256.0;
+}
+
+/* rand_byte() one bit at a time, on a copy of the seed */
+static unsigned char lfsr_byte(unsigned int *seed)
+{
+    unsigned char i;
+    for (i = 0; i < 8; ++i)
+        *seed = (*seed & 1) ? (*seed >> 1) ^ 0xB400 : *seed >> 1;
+    return (unsigned char)*seed;
+}
+
+/* Frames of play between two pieces: the LFSR and the bag shuffle tick
+ * once per frame */
+static void frames(unsigned char n)
+{
+    while (n--)
+        rand_tick();
+}
+
+/* Bring the next piece into play the way the game does: every other one
+ * picked at spawn, the rest staged during a line clear */
+static unsigned char draw(unsigned long i)
+{
+    if (i & 1) {
+        spawn_piece();
+    } else {
+        pl->staged_next = next_random_piece();
+        spawn_next(pl->staged_next);
+    }
+    return pl->cur_piece;
+}
+
+static void new_game(unsigned char mode, unsigned int seed)
+{
+    rand_mode = mode;
+    rng_seed = seed;
+    start_game(1);
+}
+
+/* ── Classic ── */
+static void test_classic(void)
+{
+    double trans[NUM_PIECES][NUM_PIECES], pi[NUM_PIECES], nx[NUM_PIECES];
+    double count[NUM_PIECES], repeat_p, repeats;
+    unsigned char prev, p, i, j;
+    unsigned int b;
+    unsigned long n;
+    int ok;
+    char what[80];
+
+    /* The fold table: every byte to its residue mod 7 */
+    new_game(RAND_CLASSIC, 1);
+    ok = 1;
+    for (b = 0; b < 256; ++b) {
+        rng_seed = b << 8;          /* the next byte is b, with no feedback */
+        pl->next_piece = NUM_PIECES;
+        if (next_random_piece() != b % 7)
+            ok = 0;
+    }
+    check(ok, "classic: MOD7 fold table matches % 7 for every byte");
+
+    /* Expected: a Markov chain over the previous piece, P(i -> j) =
+     * q(j) for j != i and q(i)^2 for a repeat; its stationary distribution */
+    for (i = 0; i < NUM_PIECES; ++i)
+        for (j = 0; j < NUM_PIECES; ++j)
+            trans[i][j] = roll_p(j) * (i == j ? roll_p(i) : 1.0 + roll_p(i));
+    for (i = 0; i < NUM_PIECES; ++i)
+        pi[i] = 1.0 / NUM_PIECES;
+    for (n = 0; n < 200; ++n) {
+        for (j = 0; j < NUM_PIECES; ++j) {
+            nx[j] = 0;
+            for (i = 0; i < NUM_PIECES; ++i)
+                nx[j] += pi[i] * trans[i][j];
+        }
+        for (j = 0; j < NUM_PIECES; ++j)
+            pi[j] = nx[j];
+    }
+    repeat_p = 0;
+    for (i = 0; i < NUM_PIECES; ++i)
+        repeat_p += pi[i] * trans[i][i];
+
+    new_game(RAND_CLASSIC, 0x1234);
+    for (i = 0; i < NUM_PIECES; ++i)
+        count[i] = 0;
+    repeats = 0;
+    prev = pl->cur_piece;
+    for (n = 0; n < DRAWS; ++n) {
+        frames((unsigned char)(rand() % 48));
+        p = draw(n);
+        ++count[p];
+        if (p == prev)
+            ++repeats;
+        prev = p;
+    }
+
+    for (i = 0; i < NUM_PIECES; ++i) {
+        snprintf(what, sizeof what, "classic: piece %u frequency %.5f, expected %.5f",
+                i, count[i] / DRAWS, pi[i]);
+        check(within(count[i], pi[i], DRAWS), what);
+    }
+    snprintf(what, sizeof what, "classic: repeat rate %.5f, expected %.5f (%.5f without the re-roll)",
+            repeats / DRAWS, repeat_p, 1.0 / NUM_PIECES);
+    check(within(repeats, repeat_p, DRAWS), what);
+}
+
+/* ── 7-bag ── */
+
+/* Chi-square of a 7x7 position/piece count table against uniform, 36
+ * degrees of freedom; 80 is far past the 99.99th percentile. Over all
+ * 65535 LFSR states the counts should look like a random function's. */
+static void check_positions(double pos[NUM_PIECES][NUM_PIECES], double bags, const char *how)
+{
+    double chi, e;
+    unsigned char i, j;
+    char what[120];
+
+    e = bags / NUM_PIECES;
+    chi = 0;
+    for (i = 0; i < NUM_PIECES; ++i)
+        for (j = 0; j < NUM_PIECES; ++j)
+            chi += (pos[i][j] - e) * (pos[i][j] - e) / e;
+    snprintf(what, sizeof what, "7-bag (%.40s): position chi-square %.1f (36 df, limit 80)", how, chi);
+    check(chi < 80.0, what);
+}
+
+/* Count a bag's pieces by position; 1 if it is a permutation */
+static unsigned char count_bag(double pos[NUM_PIECES][NUM_PIECES], const unsigned char *seq)
+{
+    unsigned char seen, i;
+
+    seen = 0;
+    for (i = 0; i < NUM_PIECES; ++i) {
+        seen |= 1 << seq[i];
+        ++pos[i][seq[i]];
+    }
+    return seen == 0x7F;
+}
+
+static void test_bag(void)
+{
+    static double pos[NUM_PIECES][NUM_PIECES];
+    unsigned char seq[NUM_PIECES], i, k;
+    unsigned long bag, perms, seed;
+    char what[100];
+
+    /* In play, pieces 0-15 frames apart: every 7 are a permutation */
+    new_game(RAND_BAG, 0x1234);
+    perms = 0;
+    seq[0] = pl->cur_piece;
+    for (bag = 0; bag < BAGS; ++bag) {
+        for (i = bag ? 0 : 1; i < NUM_PIECES; ++i) {
+            frames((unsigned char)(rand() % 16));
+            seq[i] = draw(i);
+        }
+        perms += count_bag(pos, seq);
+    }
+    snprintf(what, sizeof what, "7-bag: %lu of %lu bags in play are permutations", perms, BAGS);
+    check(perms == BAGS, what);
+
+    /* A bag is a function of the LFSR state when its shuffle starts and
+     * of how many insertions rand_tick() made before bag_refill() did the
+     * rest on the spot, so take every state for each split */
+    for (k = 0; k <= NUM_PIECES; ++k) {
+        memset(pos, 0, sizeof pos);
+        perms = 0;
+        for (seed = 1; seed <= 0xFFFF; ++seed) {
+            rng_seed = (unsigned int)seed;
+            pl->sb_n = 0;
+            pl->bag_pos = NUM_PIECES;
+            frames(k);
+            for (i = 0; i < NUM_PIECES; ++i)
+                seq[i] = next_random_piece();
+            perms += count_bag(pos, seq);
+        }
+        snprintf(what, sizeof what, "7-bag (%u of 7 inserted over frames): %lu of 65535 bags are permutations",
+                k, perms);
+        check(perms == 65535, what);
+        snprintf(what, sizeof what, "%u of 7 inserted over frames", k);
+        check_positions(pos, 65535, what);
+    }
+}
+
+/* ── History ── */
+static void test_history(void)
+{
+    unsigned char hist[4], p, roll, r, i, in_hist, fell_back;
+    unsigned int seed;
+    unsigned long n, wrong, repeats, fallbacks;
+    double hist_p, all4, expect, var;
+    char what[100];
+
+    new_game(RAND_HISTORY, 0x1234);
+    wrong = repeats = fallbacks = 0;
+    expect = var = 0;
+    for (n = 0; n < DRAWS; ++n) {
+        frames((unsigned char)(rand() % 48));
+
+        /* Predict the pick from a copy of the LFSR and the history */
+        for (i = 0; i < 4; ++i)
+            hist[i] = pl->hist[i];
+        hist_p = 0;
+        for (p = 0; p < NUM_PIECES; ++p)
+            if (p == hist[0] || p == hist[1] || p == hist[2] || p == hist[3])
+                hist_p += roll_p(p);
+        seed = rng_seed;
+        fell_back = 1;
+        for (r = 0; r < 4; ++r) {
+            roll = lfsr_byte(&seed) % 7;
+            if (roll != hist[0] && roll != hist[1] && roll != hist[2] && roll != hist[3]) {
+                fell_back = 0;
+                break;
+            }
+        }
+
+        p = next_random_piece();
+        in_hist = p == hist[0] || p == hist[1] || p == hist[2] || p == hist[3];
+        if (p != roll)
+            ++wrong;
+        if (in_hist && !fell_back)
+            ++repeats;
+        fallbacks += fell_back;
+        all4 = hist_p * hist_p * hist_p * hist_p;
+        expect += all4;
+        var += all4 * (1.0 - all4);
+    }
+
+    snprintf(what, sizeof what, "history: %lu of %ld picks differ from the 4-roll rule", wrong, DRAWS);
+    check(wrong == 0, what);
+    snprintf(what, sizeof what, "history: %lu repeats within 4 picks without a fallback", repeats);
+    check(repeats == 0, what);
+    snprintf(what, sizeof what, "history: fallback rate %.5f, expected %.5f",
+            fallbacks / (double)DRAWS, expect / DRAWS);
+    check(fabs(fallbacks - expect) <= 5.0 * sqrt(var), what);
+}
+
+int main(int argc, char **argv)
+{
+    srand(argc > 1 ? atoi(argv[1]) : 1);
+    test_classic();
+    test_bag();
+    test_history();
+
+    if (failures) {
+        printf("rand_test: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("rand_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,108 @@
+/* score_test.c - Host test for BCD scoring (make test)
+ *
+ * add_score() keeps score, lines and level in BCD: points from the
+ * score_bcd table, a digit-wise bcd_add() and the level read off the lines'
+ * digits, with no multiply or divide. Here the same clears are replayed in
+ * binary:
+ *   score  + {40, 100, 300, 1200}[lines - 1] * (level + 1), at most 999999
+ *   lines  + lines cleared, at most 9999
+ *   level  lines / 10, at most MAX_LEVEL, and level_bcd the same in BCD
+ * over CLEARS random clears, in games played from zero and from random
+ * totals up to the limits. An optional argument seeds the host's rand().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "neslib.h"
+#include "tetris.h"
+
+#define CLEARS 200000L
+
+static const unsigned long base_points[4] = { 40, 100, 300, 1200 };
+
+static unsigned long score, lines;
+static unsigned char level;
+static unsigned long failed;
+
+/* n-byte BCD number, most significant byte first, to binary */
+static unsigned long from_bcd(const unsigned char *bcd, unsigned char n)
+{
+    unsigned long v;
+    unsigned char i;
+
+    v = 0;
+    for (i = 0; i < n; ++i)
+        v = v * 100 + (bcd[i] >> 4) * 10 + (bcd[i] & 0x0F);
+    return v;
+}
+
+static void to_bcd(unsigned char *bcd, unsigned char n, unsigned long v)
+{
+    while (n--) {
+        bcd[n] = (unsigned char)(((v / 10 % 10) << 4) | (v % 10));
+        v /= 100;
+    }
+}
+
+/* Start a game at the given totals, on both sides */
+static void start(unsigned long s, unsigned long l)
+{
+    score = s;
+    lines = l;
+    level = (unsigned char)(l / 10 > MAX_LEVEL ? MAX_LEVEL : l / 10);
+    to_bcd(pl->score, 3, s);
+    to_bcd(pl->lines, 2, l);
+    pl->level = level;
+    to_bcd(&pl->level_bcd, 1, level);
+}
+
+static void clear(unsigned char n)
+{
+    add_score(n);
+
+    score += base_points[n - 1] * (level + 1);
+    if (score > 999999)
+        score = 999999;
+    lines += n;
+    if (lines > 9999)
+        lines = 9999;
+    level = (unsigned char)(lines / 10 > MAX_LEVEL ? MAX_LEVEL : lines / 10);
+
+    if (from_bcd(pl->score, 3) != score || from_bcd(pl->lines, 2) != lines
+        || pl->level != level || from_bcd(&pl->level_bcd, 1) != level) {
+        if (++failed <= 10)
+            printf("FAIL  %u lines: score %lu lines %lu level %u/%lu, expected %lu %lu %u\n",
+                   n, from_bcd(pl->score, 3), from_bcd(pl->lines, 2), pl->level,
+                   from_bcd(&pl->level_bcd, 1), score, lines, level);
+        /* Carry on from the expected totals */
+        start(score, lines);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long i;
+
+    srand(argc > 1 ? atoi(argv[1]) : 1);
+    player_select(0);
+
+    start(0, 0);
+    for (i = 0; i < CLEARS; ++i) {
+        /* Now and then a new game, from zero or from anywhere up to the
+         * limits, so saturation comes up often */
+        if (rand() % 500 == 0)
+            start(0, 0);
+        else if (rand() % 500 == 0)
+            start((unsigned long)rand() % 1000000, (unsigned long)rand() % 10000);
+        clear((unsigned char)(1 + rand() % 4));
+    }
+
+    printf("%s  score, lines and level: %lu of %lu clears match the binary arithmetic\n",
+           failed ? "FAIL" : "ok  ", CLEARS - failed, CLEARS);
+    if (failed) {
+        printf("score_test: %lu clear(s) differ\n", failed);
+        return 1;
+    }
+    printf("score_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,350 @@
+/* sim6502.c - Minimal NMOS 6502 simulator for host tests (see sim6502.h) */
+
+#include "sim6502.h"
+
+/* Status flags */
+#define F_C 0x01
+#define F_Z 0x02
+#define F_I 0x04
+#define F_D 0x08
+#define F_B 0x10
+#define F_U 0x20
+#define F_V 0x40
+#define F_N 0x80
+
+/* Addressing modes */
+enum { IMP, ACC, IMM, ZP, ZPX, ZPY, ABS, ABX, ABY, IND, IZX, IZY, REL };
+
+/* Operations */
+enum {
+    ILL, ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRK, BVC, BVS, CLC,
+    CLD, CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX, INY, JMP,
+    JSR, LDA, LDX, LDY, LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL, ROR, RTI,
+    RTS, SBC, SEC, SED, SEI, STA, STX, STY, TAX, TAY, TSX, TXA, TXS, TYA,
+};
+
+typedef struct {
+    unsigned char op, mode, cycles;
+} opcode_t;
+
+/* Official opcodes; the rest decode as ILL */
+static const struct {
+    unsigned char code;
+    opcode_t def;
+} opcode_list[] = {
+    {0x69,{ADC,IMM,2}},{0x65,{ADC,ZP,3}},{0x75,{ADC,ZPX,4}},{0x6D,{ADC,ABS,4}},
+    {0x7D,{ADC,ABX,4}},{0x79,{ADC,ABY,4}},{0x61,{ADC,IZX,6}},{0x71,{ADC,IZY,5}},
+    {0x29,{AND,IMM,2}},{0x25,{AND,ZP,3}},{0x35,{AND,ZPX,4}},{0x2D,{AND,ABS,4}},
+    {0x3D,{AND,ABX,4}},{0x39,{AND,ABY,4}},{0x21,{AND,IZX,6}},{0x31,{AND,IZY,5}},
+    {0x0A,{ASL,ACC,2}},{0x06,{ASL,ZP,5}},{0x16,{ASL,ZPX,6}},{0x0E,{ASL,ABS,6}},
+    {0x1E,{ASL,ABX,7}},
+    {0x90,{BCC,REL,2}},{0xB0,{BCS,REL,2}},{0xF0,{BEQ,REL,2}},{0x30,{BMI,REL,2}},
+    {0xD0,{BNE,REL,2}},{0x10,{BPL,REL,2}},{0x50,{BVC,REL,2}},{0x70,{BVS,REL,2}},
+    {0x24,{BIT,ZP,3}},{0x2C,{BIT,ABS,4}},
+    {0x00,{BRK,IMP,7}},
+    {0x18,{CLC,IMP,2}},{0xD8,{CLD,IMP,2}},{0x58,{CLI,IMP,2}},{0xB8,{CLV,IMP,2}},
+    {0xC9,{CMP,IMM,2}},{0xC5,{CMP,ZP,3}},{0xD5,{CMP,ZPX,4}},{0xCD,{CMP,ABS,4}},
+    {0xDD,{CMP,ABX,4}},{0xD9,{CMP,ABY,4}},{0xC1,{CMP,IZX,6}},{0xD1,{CMP,IZY,5}},
+    {0xE0,{CPX,IMM,2}},{0xE4,{CPX,ZP,3}},{0xEC,{CPX,ABS,4}},
+    {0xC0,{CPY,IMM,2}},{0xC4,{CPY,ZP,3}},{0xCC,{CPY,ABS,4}},
+    {0xC6,{DEC,ZP,5}},{0xD6,{DEC,ZPX,6}},{0xCE,{DEC,ABS,6}},{0xDE,{DEC,ABX,7}},
+    {0xCA,{DEX,IMP,2}},{0x88,{DEY,IMP,2}},
+    {0x49,{EOR,IMM,2}},{0x45,{EOR,ZP,3}},{0x55,{EOR,ZPX,4}},{0x4D,{EOR,ABS,4}},
+    {0x5D,{EOR,ABX,4}},{0x59,{EOR,ABY,4}},{0x41,{EOR,IZX,6}},{0x51,{EOR,IZY,5}},
+    {0xE6,{INC,ZP,5}},{0xF6,{INC,ZPX,6}},{0xEE,{INC,ABS,6}},{0xFE,{INC,ABX,7}},
+    {0xE8,{INX,IMP,2}},{0xC8,{INY,IMP,2}},
+    {0x4C,{JMP,ABS,3}},{0x6C,{JMP,IND,5}},{0x20,{JSR,ABS,6}},
+    {0xA9,{LDA,IMM,2}},{0xA5,{LDA,ZP,3}},{0xB5,{LDA,ZPX,4}},{0xAD,{LDA,ABS,4}},
+    {0xBD,{LDA,ABX,4}},{0xB9,{LDA,ABY,4}},{0xA1,{LDA,IZX,6}},{0xB1,{LDA,IZY,5}},
+    {0xA2,{LDX,IMM,2}},{0xA6,{LDX,ZP,3}},{0xB6,{LDX,ZPY,4}},{0xAE,{LDX,ABS,4}},
+    {0xBE,{LDX,ABY,4}},
+    {0xA0,{LDY,IMM,2}},{0xA4,{LDY,ZP,3}},{0xB4,{LDY,ZPX,4}},{0xAC,{LDY,ABS,4}},
+    {0xBC,{LDY,ABX,4}},
+    {0x4A,{LSR,ACC,2}},{0x46,{LSR,ZP,5}},{0x56,{LSR,ZPX,6}},{0x4E,{LSR,ABS,6}},
+    {0x5E,{LSR,ABX,7}},
+    {0xEA,{NOP,IMP,2}},
+    {0x09,{ORA,IMM,2}},{0x05,{ORA,ZP,3}},{0x15,{ORA,ZPX,4}},{0x0D,{ORA,ABS,4}},
+    {0x1D,{ORA,ABX,4}},{0x19,{ORA,ABY,4}},{0x01,{ORA,IZX,6}},{0x11,{ORA,IZY,5}},
+    {0x48,{PHA,IMP,3}},{0x08,{PHP,IMP,3}},{0x68,{PLA,IMP,4}},{0x28,{PLP,IMP,4}},
+    {0x2A,{ROL,ACC,2}},{0x26,{ROL,ZP,5}},{0x36,{ROL,ZPX,6}},{0x2E,{ROL,ABS,6}},
+    {0x3E,{ROL,ABX,7}},
+    {0x6A,{ROR,ACC,2}},{0x66,{ROR,ZP,5}},{0x76,{ROR,ZPX,6}},{0x6E,{ROR,ABS,6}},
+    {0x7E,{ROR,ABX,7}},
+    {0x40,{RTI,IMP,6}},{0x60,{RTS,IMP,6}},
+    {0xE9,{SBC,IMM,2}},{0xE5,{SBC,ZP,3}},{0xF5,{SBC,ZPX,4}},{0xED,{SBC,ABS,4}},
+    {0xFD,{SBC,ABX,4}},{0xF9,{SBC,ABY,4}},{0xE1,{SBC,IZX,6}},{0xF1,{SBC,IZY,5}},
+    {0x38,{SEC,IMP,2}},{0xF8,{SED,IMP,2}},{0x78,{SEI,IMP,2}},
+    {0x85,{STA,ZP,3}},{0x95,{STA,ZPX,4}},{0x8D,{STA,ABS,4}},{0x9D,{STA,ABX,5}},
+    {0x99,{STA,ABY,5}},{0x81,{STA,IZX,6}},{0x91,{STA,IZY,6}},
+    {0x86,{STX,ZP,3}},{0x96,{STX,ZPY,4}},{0x8E,{STX,ABS,4}},
+    {0x84,{STY,ZP,3}},{0x94,{STY,ZPX,4}},{0x8C,{STY,ABS,4}},
+    {0xAA,{TAX,IMP,2}},{0xA8,{TAY,IMP,2}},{0xBA,{TSX,IMP,2}},{0x8A,{TXA,IMP,2}},
+    {0x9A,{TXS,IMP,2}},{0x98,{TYA,IMP,2}},
+};
+
+static opcode_t opcodes[256];
+static unsigned char opcodes_ready;
+
+static void init_opcodes(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof opcode_list / sizeof opcode_list[0]; ++i)
+        opcodes[opcode_list[i].code] = opcode_list[i].def;
+    opcodes_ready = 1;
+}
+
+/* ── Helpers ── */
+static unsigned int rd16(cpu6502_t *c, unsigned int a)
+{
+    return c->mem[a & 0xFFFF] | (c->mem[(a + 1) & 0xFFFF] << 8);
+}
+
+static void push(cpu6502_t *c, unsigned char v)
+{
+    c->mem[0x100 | c->s] = v;
+    --c->s;
+}
+
+static unsigned char pull(cpu6502_t *c)
+{
+    ++c->s;
+    return c->mem[0x100 | c->s];
+}
+
+static void set_nz(cpu6502_t *c, unsigned char v)
+{
+    c->p &= ~(F_N | F_Z);
+    c->p |= v & F_N;
+    if (!v)
+        c->p |= F_Z;
+}
+
+static void compare(cpu6502_t *c, unsigned char r, unsigned char m)
+{
+    c->p &= ~F_C;
+    if (r >= m)
+        c->p |= F_C;
+    set_nz(c, (unsigned char)(r - m));
+}
+
+static void add(cpu6502_t *c, unsigned char m)
+{
+    unsigned int t;
+
+    t = c->a + m + (c->p & F_C);
+    c->p &= ~(F_C | F_V);
+    if (t > 0xFF)
+        c->p |= F_C;
+    if (~(c->a ^ m) & (c->a ^ t) & 0x80)
+        c->p |= F_V;
+    c->a = (unsigned char)t;
+    set_nz(c, c->a);
+}
+
+/* Shifts and rotates, shared by the accumulator and memory forms */
+static unsigned char shift(cpu6502_t *c, unsigned char op, unsigned char v)
+{
+    unsigned char carry_in, out;
+
+    carry_in = c->p & F_C;
+    switch (op) {
+    case ASL: out = v & 0x80; v <<= 1; break;
+    case LSR: out = v & 0x01; v >>= 1; break;
+    case ROL: out = v & 0x80; v = (unsigned char)(v << 1) | carry_in; break;
+    default:  out = v & 0x01; v = (unsigned char)(v >> 1) | (carry_in << 7); break;
+    }
+    c->p &= ~F_C;
+    if (out)
+        c->p |= F_C;
+    set_nz(c, v);
+    return v;
+}
+
+void sim_reset(cpu6502_t *c)
+{
+    c->a = c->x = c->y = 0;
+    c->s = 0xFD;
+    c->p = F_U | F_I;
+    c->pc = 0;
+    c->cycles = 0;
+}
+
+/* ── Execute one instruction; 0 on an illegal opcode or BRK ── */
+static int step(cpu6502_t *c)
+{
+    opcode_t o;
+    unsigned int adr, base;
+    unsigned char v, cross, taken;
+
+    o = opcodes[c->mem[c->pc]];
+    c->pc = (c->pc + 1) & 0xFFFF;
+    c->cycles += o.cycles;
+
+    /* Effective address; cross = a page was crossed indexing */
+    adr = 0;
+    cross = 0;
+    switch (o.mode) {
+    case IMM: adr = c->pc; c->pc += 1; break;
+    case ZP:  adr = c->mem[c->pc]; c->pc += 1; break;
+    case ZPX: adr = (c->mem[c->pc] + c->x) & 0xFF; c->pc += 1; break;
+    case ZPY: adr = (c->mem[c->pc] + c->y) & 0xFF; c->pc += 1; break;
+    case ABS: adr = rd16(c, c->pc); c->pc += 2; break;
+    case ABX:
+    case ABY:
+        base = rd16(c, c->pc);
+        c->pc += 2;
+        adr = (base + (o.mode == ABX ? c->x : c->y)) & 0xFFFF;
+        cross = (adr ^ base) > 0xFF;
+        break;
+    case IND:
+        /* JMP ($xxFF) reads the high byte from $xx00 */
+        base = rd16(c, c->pc);
+        c->pc += 2;
+        adr = c->mem[base] | (c->mem[(base & 0xFF00) | ((base + 1) & 0xFF)] << 8);
+        break;
+    case IZX:
+        base = (c->mem[c->pc] + c->x) & 0xFF;
+        c->pc += 1;
+        adr = c->mem[base] | (c->mem[(base + 1) & 0xFF] << 8);
+        break;
+    case IZY:
+        base = c->mem[c->pc];
+        c->pc += 1;
+        base = c->mem[base] | (c->mem[(base + 1) & 0xFF] << 8);
+        adr = (base + c->y) & 0xFFFF;
+        cross = (adr ^ base) > 0xFF;
+        break;
+    case REL:
+        adr = (c->pc + 1 + (signed char)c->mem[c->pc]) & 0xFFFF;
+        c->pc += 1;
+        break;
+    }
+    c->pc &= 0xFFFF;
+    adr &= 0xFFFF;
+
+    /* Reads pay for a page crossed; stores and read-modify-writes always
+     * take the long path, which their base cycles already count */
+    switch (o.op) {
+    case ADC: case AND: case CMP: case EOR: case LDA: case LDX: case LDY:
+    case ORA: case SBC:
+        c->cycles += cross;
+        break;
+    }
+
+    taken = 0;
+    switch (o.op) {
+    case ILL: case BRK: return 0;
+
+    case ADC: add(c, c->mem[adr]); break;
+    case SBC: add(c, c->mem[adr] ^ 0xFF); break;
+    case AND: c->a &= c->mem[adr]; set_nz(c, c->a); break;
+    case ORA: c->a |= c->mem[adr]; set_nz(c, c->a); break;
+    case EOR: c->a ^= c->mem[adr]; set_nz(c, c->a); break;
+    case CMP: compare(c, c->a, c->mem[adr]); break;
+    case CPX: compare(c, c->x, c->mem[adr]); break;
+    case CPY: compare(c, c->y, c->mem[adr]); break;
+    case BIT:
+        v = c->mem[adr];
+        c->p &= ~(F_N | F_V | F_Z);
+        c->p |= v & (F_N | F_V);
+        if (!(c->a & v))
+            c->p |= F_Z;
+        break;
+
+    case ASL: case LSR: case ROL: case ROR:
+        if (o.mode == ACC)
+            c->a = shift(c, o.op, c->a);
+        else
+            c->mem[adr] = shift(c, o.op, c->mem[adr]);
+        break;
+    case INC: ++c->mem[adr]; set_nz(c, c->mem[adr]); break;
+    case DEC: --c->mem[adr]; set_nz(c, c->mem[adr]); break;
+    case INX: ++c->x; set_nz(c, c->x); break;
+    case INY: ++c->y; set_nz(c, c->y); break;
+    case DEX: --c->x; set_nz(c, c->x); break;
+    case DEY: --c->y; set_nz(c, c->y); break;
+
+    case LDA: c->a = c->mem[adr]; set_nz(c, c->a); break;
+    case LDX: c->x = c->mem[adr]; set_nz(c, c->x); break;
+    case LDY: c->y = c->mem[adr]; set_nz(c, c->y); break;
+    case STA: c->mem[adr] = c->a; break;
+    case STX: c->mem[adr] = c->x; break;
+    case STY: c->mem[adr] = c->y; break;
+    case TAX: c->x = c->a; set_nz(c, c->x); break;
+    case TAY: c->y = c->a; set_nz(c, c->y); break;
+    case TXA: c->a = c->x; set_nz(c, c->a); break;
+    case TYA: c->a = c->y; set_nz(c, c->a); break;
+    case TSX: c->x = c->s; set_nz(c, c->x); break;
+    case TXS: c->s = c->x; break;
+
+    case PHA: push(c, c->a); break;
+    case PHP: push(c, c->p | F_B | F_U); break;
+    case PLA: c->a = pull(c); set_nz(c, c->a); break;
+    case PLP: c->p = (pull(c) & ~F_B) | F_U; break;
+
+    case BCC: taken = !(c->p & F_C); break;
+    case BCS: taken = (c->p & F_C) != 0; break;
+    case BNE: taken = !(c->p & F_Z); break;
+    case BEQ: taken = (c->p & F_Z) != 0; break;
+    case BPL: taken = !(c->p & F_N); break;
+    case BMI: taken = (c->p & F_N) != 0; break;
+    case BVC: taken = !(c->p & F_V); break;
+    case BVS: taken = (c->p & F_V) != 0; break;
+
+    case JMP: c->pc = adr; break;
+    case JSR:
+        base = (c->pc - 1) & 0xFFFF;
+        push(c, (unsigned char)(base >> 8));
+        push(c, (unsigned char)base);
+        c->pc = adr;
+        break;
+    case RTS:
+        base = pull(c);
+        base |= pull(c) << 8;
+        c->pc = (base + 1) & 0xFFFF;
+        break;
+    case RTI:
+        c->p = (pull(c) & ~F_B) | F_U;
+        base = pull(c);
+        base |= pull(c) << 8;
+        c->pc = base;
+        break;
+
+    case CLC: c->p &= ~F_C; break;
+    case SEC: c->p |= F_C; break;
+    case CLI: c->p &= ~F_I; break;
+    case SEI: c->p |= F_I; break;
+    case CLV: c->p &= ~F_V; break;
+    case CLD: c->p &= ~F_D; break;
+    case SED: c->p |= F_D; break;
+    case NOP: break;
+    }
+
+    if (taken) {
+        c->cycles += 1 + (((c->pc ^ adr) & 0xFF00) != 0);
+        c->pc = adr;
+    }
+    return 1;
+}
+
+unsigned long sim_call(cpu6502_t *c, unsigned int adr, unsigned long max_cycles)
+{
+    unsigned long start;
+    unsigned char s;
+
+    if (!opcodes_ready)
+        init_opcodes();
+
+    /* Return address $FFFE: the RTS back to $FFFF ends the call */
+    s = c->s;
+    push(c, 0xFF);
+    push(c, 0xFE);
+    c->pc = adr & 0xFFFF;
+    start = c->cycles;
+    while (c->pc != 0xFFFF || c->s != s) {
+        if (!step(c) || c->cycles - start > max_cycles)
+            return 0;
+    }
+    return c->cycles - start;
+}
@@ -0,0 +1,25 @@
+/* sim6502.h - Minimal NMOS 6502 simulator for host tests
+ *
+ * All official opcodes with their cycle counts (page-crossing and branch
+ * penalties included), 64KB of flat RAM, no I/O and no decimal mode, as on
+ * the NES's 2A03. Used by tools/kernel_test.c to run kernels.s.
+ */
+
+#ifndef _SIM6502_H
+#define _SIM6502_H
+
+typedef struct {
+    unsigned char a, x, y, s, p;
+    unsigned int pc;
+    unsigned long cycles;
+    unsigned char mem[0x10000];
+} cpu6502_t;
+
+/* Reset registers: S = $FD, interrupts disabled, cycle count 0 */
+void sim_reset(cpu6502_t *c);
+
+/* JSR to adr and run until it returns; returns the cycles taken, or 0 if
+ * an illegal opcode or BRK was hit or it ran over max_cycles */
+unsigned long sim_call(cpu6502_t *c, unsigned int adr, unsigned long max_cycles);
+
+#endif /* _SIM6502_H */
@@ -0,0 +1,324 @@
+#!/usr/bin/env python3
+"""Search for worst-case frames of the game core and replay them.
+
+The game sources are compiled natively, with TRACE markers, and linked
+with tools/stress_host.c (basic-block cost counters, the NMI) and
+tools/host_neslib.c (a stand-in neslib). A scenario is a starting position
+for each player (playfield, level, score, lines, current and next piece)
+plus the controller input of every frame; running it reports, per frame:
+  blocks     basic blocks executed, a CPU-time proxy
+  queued     VRAM queue entries the NMI has to drain, plus a palette
+             upload counted as the entries it would take instead
+  unchecked  entries queued with no room check (lock, next preview, a
+             palette upload) before vram_step() fills the rest of the budget
+  backlog    entries still pending after the frame (rows to redraw, flash
+             tiles and attributes, stale HUD digits)
+The VRAM objective is the demand, unchecked + backlog: the queue itself
+never goes past the budget unless the unchecked writes do. The title's
+label writes count as frame -1.
+
+  search  random-restart hill climbing over scenarios, maximizing the worst
+          frame's blocks or VRAM demand; the best one is saved as a
+          fixture (JSON) with its recorded costs
+  replay  run fixtures, check every frame's NMI work against the
+          region's budget and compare costs with the recorded ones
+          (`make test` replays tools/stress/*.json)
+
+Usage:
+  stress.py search --objective vram --players 2 -o tools/stress/vs-vram.json
+  stress.py replay tools/stress/*.json
+"""
+
+import argparse
+import glob
+import json
+import os
+import random
+import subprocess
+import sys
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+SRCDIR = os.path.join(ROOT, 'src')
+TOOLDIR = os.path.join(ROOT, 'tools')
+BUILDDIR = os.path.join(ROOT, 'build', 'stress')
+
+# Must match the Makefile (BOARD_*) and neslib.h / crt0.s
+BOARDS = {'std': (10, 20, 2), 'wide': (12, 20, 2), 'tall': (10, 24, 2), 'narrow': (6, 20, 2)}
+REGIONS = {'ntsc': 0, 'pal': 1, 'dendy': 2}
+BUDGETS = {'ntsc': 42, 'pal': 84, 'dendy': 42}
+MAX_LEVEL = 39
+NUM_PIECES = 7
+
+# Pad bits (neslib.h) and the inputs the search picks from
+PAD_A, PAD_B, PAD_UP, PAD_DOWN, PAD_LEFT, PAD_RIGHT = 0x80, 0x40, 0x08, 0x04, 0x02, 0x01
+MOVES = [0, 0, 0, PAD_UP, PAD_UP, PAD_LEFT, PAD_RIGHT, PAD_A, PAD_B, PAD_DOWN,
+         PAD_UP | PAD_LEFT, PAD_UP | PAD_RIGHT, PAD_UP | PAD_A]
+
+# Score, lines and level values near rollovers and limits
+SCORES = ['000000', '009990', '099960', '998800', '999000', '999960', '999999']
+LINES = ['0000', '0009', '0099', '0289', '0389', '9999']
+
+
+def build_host(board):
+    """Compile the host for a board geometry; return the executable path."""
+    w, h, y = BOARDS[board]
+    out = os.path.join(BUILDDIR, board)
+    exe = os.path.join(out, 'stress_host')
+    sources = sorted(glob.glob(os.path.join(SRCDIR, '*.c')))
+    deps = sources + glob.glob(os.path.join(SRCDIR, '*.h')) + [
+        os.path.join(TOOLDIR, 'stress_host.c'), os.path.join(TOOLDIR, 'host_neslib.c'),
+        os.path.join(TOOLDIR, 'board_gen.py'),
+        os.path.join(TOOLDIR, 'tables_gen.py')]
+    if os.path.exists(exe) and all(os.path.getmtime(d) <= os.path.getmtime(exe) for d in deps):
+        return exe
+
+    os.makedirs(out, exist_ok=True)
+    run = lambda cmd: subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+    run([sys.executable, os.path.join(TOOLDIR, 'board_gen.py'), str(w), str(h), str(y),
+         os.path.join(out, 'board.h')])
+    run([sys.executable, os.path.join(TOOLDIR, 'tables_gen.py'), os.path.join(out, 'tables.h')])
+
+    cc = os.environ.get('CC', 'cc')
+    flags = ['-std=gnu99', '-O1', '-w', '-D__fastcall__=', '-DTRACE', '-I', SRCDIR, '-I', out]
+    objs = []
+    for src in sources:
+        obj = os.path.join(out, os.path.basename(src)[:-2] + '.o')
+        extra = ['-Dmain=game_main'] if src.endswith('main.c') else []
+        run([cc] + flags + extra + ['-fsanitize-coverage=trace-pc', '-c', src, '-o', obj])
+        objs.append(obj)
+    run([cc] + flags + [os.path.join(TOOLDIR, 'stress_host.c'), os.path.join(TOOLDIR, 'host_neslib.c')]
+        + objs + ['-o', exe])
+    return exe
+
+
+# ── Scenarios ──
+
+def new_player(w, h, rng):
+    """A random stack: rows from a random height down, each with one hole or a few."""
+    top = rng.randrange(2, h)
+    rows = []
+    for r in range(h):
+        if r < top:
+            rows.append('.' * w)
+        else:
+            cells = ['#'] * w
+            for _ in range(rng.choice([1, 1, 1, 2])):
+                cells[rng.randrange(w)] = '.'
+            rows.append(''.join(cells))
+    return {'level': rng.randrange(MAX_LEVEL + 1), 'score': rng.choice(SCORES),
+            'lines': rng.choice(LINES), 'piece': rng.randrange(NUM_PIECES),
+            'next': rng.randrange(NUM_PIECES), 'playfield': rows}
+
+
+def new_scenario(args, rng):
+    w, h, _ = BOARDS[args.board]
+    return {
+        'board': args.board, 'region': args.region, 'rand_mode': 0,
+        'seed': rng.randrange(1, 65536), 'frames': args.frames,
+        'players': [new_player(w, h, rng) for _ in range(args.players)],
+        'pads': [[rng.choice(MOVES), rng.choice(MOVES)] for _ in range(args.frames)],
+    }
+
+
+def mutate(scn, rng):
+    """Return a copy of scn with one random change."""
+    s = json.loads(json.dumps(scn))
+    w, h, _ = BOARDS[s['board']]
+    p = rng.choice(s['players'])
+    rows = p['playfield']
+    kind = rng.randrange(9)
+    if kind == 0:                               # flip a cell
+        r, c = rng.randrange(h), rng.randrange(w)
+        rows[r] = rows[r][:c] + ('.' if rows[r][c] != '.' else '#') + rows[r][c + 1:]
+    elif kind == 1:                             # a row one cell short of full
+        r, c = rng.randrange(h), rng.randrange(w)
+        rows[r] = '#' * c + '.' + '#' * (w - c - 1)
+    elif kind == 2:                             # raise or lower the stack
+        if rng.random() < 0.5:
+            rows[:] = rows[1:] + [rows[-1]]
+        else:
+            rows[:] = ['.' * w] + rows[:-1]
+    elif kind == 3:
+        p['level'] = rng.randrange(MAX_LEVEL + 1)
+    elif kind == 4:
+        p['score'] = rng.choice(SCORES)
+    elif kind == 5:
+        p['lines'] = rng.choice(LINES)
+    elif kind == 6:
+        p['piece' if rng.random() < 0.5 else 'next'] = rng.randrange(NUM_PIECES)
+    elif kind == 7:
+        s['seed'] = rng.randrange(1, 65536)
+    else:                                       # change some inputs
+        for _ in range(rng.randrange(1, 4)):
+            f = rng.randrange(len(s['pads']))
+            s['pads'][f][rng.randrange(2)] = rng.choice(MOVES)
+    return s
+
+
+def scenario_text(scn):
+    """The stdin format read by stress_host.c."""
+    lines = [f"region {REGIONS[scn['region']]}", f"players {len(scn['players'])}",
+             f"rand {scn['rand_mode']}", f"seed {scn['seed']}", f"frames {scn['frames']}"]
+    for n, p in enumerate(scn['players']):
+        sc, ln = p['score'], p['lines']
+        lines.append(f"player {n} {p['level']} {sc[0:2]} {sc[2:4]} {sc[4:6]} {ln[0:2]} {ln[2:4]}"
+                     f" {p['piece']} {p['next']}")
+        for r, row in enumerate(p['playfield']):
+            lines.append(f"row {n} {r} {row}")
+    for f, (a, b) in enumerate(scn['pads']):
+        if a or b:
+            lines.append(f"pad {f} {a:02x} {b:02x}")
+    return '\n'.join(lines) + '\n'
+
+
+RESULTS = ('worst_blocks', 'worst_vram', 'worst_unchecked')
+
+
+def run(exe, scn):
+    """Run a scenario; return None if invalid, else a result dict."""
+    out = subprocess.run([exe], input=scenario_text(scn), capture_output=True, text=True, check=True)
+    res = {'frames': []}
+    for line in out.stdout.splitlines():
+        f = line.split()
+        if f[0] == 'invalid':
+            return None
+        if f[0] == 'frame':
+            res['frames'].append(tuple(int(x) for x in f[1:6]))
+        elif f[0] in RESULTS:
+            res[f[0]] = [int(f[1]), int(f[2])]
+        elif f[0] == 'overflow':
+            res['overflow'] = int(f[1])
+    return res
+
+
+def score(res, objective):
+    """Search objective: the chosen worst-frame cost, the other one breaking ties."""
+    if res is None:
+        return (-1, -1)
+    blocks, vram = res['worst_blocks'][1], res['worst_vram'][1]
+    return (vram, blocks) if objective == 'vram' else (blocks, vram)
+
+
+# ── Commands ──
+
+def cmd_search(args):
+    if args.players > 1 and BOARDS[args.board][0] > 10:
+        sys.exit(f'{args.board}: boards wider than 10 columns have no versus mode')
+    rng = random.Random(args.seed)
+    exe = build_host(args.board)
+    best, best_res, best_score = None, None, (-1, -1)
+    for restart in range(args.restarts):
+        cur = new_scenario(args, rng)
+        cur_res = run(exe, cur)
+        cur_score = score(cur_res, args.objective)
+        for _ in range(args.steps):
+            cand = mutate(cur, rng)
+            cand_res = run(exe, cand)
+            cand_score = score(cand_res, args.objective)
+            if cand_score >= cur_score:
+                cur, cur_res, cur_score = cand, cand_res, cand_score
+        print(f"restart {restart}: blocks {cur_score[0 if args.objective == 'blocks' else 1]}"
+              f" vram {cur_score[1 if args.objective == 'blocks' else 0]}")
+        if cur_score > best_score:
+            best, best_res, best_score = cur, cur_res, cur_score
+
+    if best is None:
+        sys.exit('No valid scenario found')
+    best['name'] = os.path.splitext(os.path.basename(args.output))[0]
+    best['objective'] = args.objective
+    best['result'] = {k: best_res[k] for k in RESULTS}
+    os.makedirs(os.path.dirname(args.output) or '.', exist_ok=True)
+    write_fixture(args.output, best)
+    print(f"Wrote {args.output}: worst blocks {best_res['worst_blocks'][1]}"
+          f" (frame {best_res['worst_blocks'][0]}), worst VRAM demand {best_res['worst_vram'][1]}"
+          f" (frame {best_res['worst_vram'][0]}), unchecked {best_res['worst_unchecked'][1]}"
+          f"/{BUDGETS[best['region']]}")
+
+
+def write_fixture(path, scn):
+    """Write a fixture as JSON with one board row, and ten frames of input,
+    per line so fixtures stay readable and diffable."""
+    d = json.dumps
+    out = ['{']
+    for key in ('name', 'objective', 'board', 'region', 'rand_mode', 'seed', 'frames'):
+        if key in scn:
+            out.append(f' {d(key)}: {d(scn[key])},')
+    out.append(' "players": [')
+    for i, p in enumerate(scn['players']):
+        out.append('  {' + ', '.join(f'{d(k)}: {d(p[k])}' for k in
+                                     ('level', 'score', 'lines', 'piece', 'next')) + ',')
+        out.append('   "playfield": [')
+        out += [f'    {d(row)}' + (',' if r < len(p['playfield']) - 1 else '')
+                for r, row in enumerate(p['playfield'])]
+        out.append('  ]}' + (',' if i < len(scn['players']) - 1 else ''))
+    out.append(' ],')
+    pads = scn['pads']
+    out.append(' "pads": [')
+    for f in range(0, len(pads), 10):
+        chunk = ', '.join(d(x) for x in pads[f:f + 10])
+        out.append(f'  {chunk}' + (',' if f + 10 < len(pads) else ''))
+    out.append(' ],')
+    out.append(f' "result": {d(scn.get("result", {}))}')
+    out.append('}')
+    with open(path, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+def cmd_replay(args):
+    failed = 0
+    for path in args.fixtures:
+        with open(path) as f:
+            scn = json.load(f)
+        res = run(build_host(scn['board']), scn)
+        if res is None:
+            print(f"{path}: INVALID (a piece overlaps its board)")
+            failed += 1
+            continue
+        budget = BUDGETS[scn['region']]
+        wb, wv, wu = res['worst_blocks'], res['worst_vram'], res['worst_unchecked']
+        line = (f"{path}: worst blocks {wb[1]} (frame {wb[0]}), worst VRAM demand {wv[1]}"
+                f" (frame {wv[0]}), unchecked {wu[1]}/{budget}")
+        rec = scn.get('result', {})
+        if rec and any(rec.get(k) != res[k] for k in RESULTS):
+            line += (f" [recorded: blocks {rec['worst_blocks'][1]}, VRAM demand"
+                     f" {rec['worst_vram'][1]}, unchecked {rec.get('worst_unchecked', ['-', '-'])[1]}]")
+            if args.update:
+                scn['result'] = {k: res[k] for k in RESULTS}
+                write_fixture(path, scn)
+                line += ' updated'
+        if res['overflow'] >= 0:
+            line += f" OVER BUDGET at frame {res['overflow']}"
+            failed += 1
+        print(line)
+    if failed:
+        sys.exit(f"{failed} fixture(s) failed")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    sub = ap.add_subparsers(dest='cmd', required=True)
+
+    s = sub.add_parser('search', help='search for a worst-case scenario')
+    s.add_argument('--objective', choices=['blocks', 'vram'], default='blocks')
+    s.add_argument('--board', choices=sorted(BOARDS), default='std')
+    s.add_argument('--region', choices=sorted(REGIONS), default='ntsc')
+    s.add_argument('--players', type=int, choices=[1, 2], default=1)
+    s.add_argument('--frames', type=int, default=40, help='frames per scenario')
+    s.add_argument('--restarts', type=int, default=8)
+    s.add_argument('--steps', type=int, default=300, help='mutations per restart')
+    s.add_argument('--seed', type=int, default=1, help='search RNG seed')
+    s.add_argument('-o', '--output', required=True, help='fixture to write')
+
+    r = sub.add_parser('replay', help='replay fixtures and check budgets')
+    r.add_argument('fixtures', nargs='+')
+    r.add_argument('--update', action='store_true', help='rewrite changed recorded costs')
+
+    args = ap.parse_args()
+    if args.cmd == 'search':
+        cmd_search(args)
+    else:
+        cmd_replay(args)
+
+
+if __name__ == '__main__':
+    main()
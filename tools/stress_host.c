@@ -0,0 +1,328 @@
+/* stress_host.c - Native host for tools/stress.py
+ *
+ * Links against the game sources (every .c file in src/, C kernels, built
+ * with TRACE) and tools/host_neslib.c, and stands in for the NMI. The real
+ * main loop runs: it is taken through the title and the screen build, then
+ * the scenario read from stdin is loaded into the players at the first
+ * playing frame and its inputs are fed one frame at a time.
+ *
+ * Cost counters, per frame (between two ppu_wait_nmi() calls):
+ *   blocks     basic blocks executed in the game sources (they are built
+ *              with -fsanitize-coverage=trace-pc; this file is not), a
+ *              CPU-time proxy
+ *   queued     VRAM queue entries waiting for the NMI, plus PAL_UPLOAD
+ *              for a palette upload (pal_dirty)
+ *   unchecked  entries queued with no room check (lock, next preview, a
+ *              palette upload) before the frame's vram_step(), taken at
+ *              its EV_VRAM marker; only these can push the NMI's work over
+ *              the budget
+ *   backlog    entries still pending at the end of the frame: rows to
+ *              redraw, flash tiles and attributes, stale HUD digits
+ * The VRAM demand of a frame is unchecked + backlog. vram_step() fills the
+ * queue up to the budget, so the queue length alone never exceeds it. The
+ * title frames, whose label writes are all unchecked, are counted too, as
+ * frame -1: the setup redraws both labels in one frame.
+ *
+ * Scenario (stdin, one item per line):
+ *   region <0-2>          players <1-2>          rand <mode>
+ *   seed <n>              frames <n>
+ *   player <n> <level> <score bcd x3> <lines bcd x2> <piece> <next>
+ *   row <n> <r> <PF_W chars, '.' empty, anything else filled>
+ *   pad <frame> <pad 1> <pad 2>     (hex; frames without a line read 0)
+ *
+ * Output: one "frame <n> <blocks> <queued> <unchecked> <backlog> <state>"
+ * line per scenario frame, then "worst_blocks", "worst_vram" (demand),
+ * "worst_unchecked" and "overflow" summary lines; or just
+ * "invalid" if a loaded piece overlaps its board.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "neslib.h"
+#include "tetris.h"
+
+#define MAX_FRAMES 600
+#define SETUP_FRAMES 200    /* title + screen build must finish by then */
+
+/* The NMI's 32-byte palette upload (crt0.s, about 500 cycles) in VRAM
+ * queue entries of 35 cycles, rounded up */
+#define PAL_UPLOAD 15
+
+void game_main(void);
+
+/* ── Scenario ── */
+typedef struct {
+    unsigned char level;
+    unsigned char score[3];
+    unsigned char lines[2];
+    unsigned char piece;
+    unsigned char next;
+    char rows[PF_H][PF_W + 1];
+} scn_player_t;
+
+static unsigned char scn_players = 1;
+static unsigned char scn_rand;
+static unsigned int scn_seed = 0x1234;
+static int scn_frames = 60;
+static scn_player_t scn[MAX_PLAYERS];
+static unsigned char scn_pad[MAX_FRAMES][MAX_PLAYERS];
+
+/* ── Run state ── */
+static unsigned long blocks;
+static unsigned int unchecked, backlog;
+static unsigned char pal_dirty;
+static int setup_frame;         /* frames before the scenario started */
+static int frame = -1;          /* scenario frame, -1 while setting up */
+static unsigned long worst_blocks, worst_vram, worst_unchecked;
+static int worst_blocks_at, worst_vram_at, worst_unchecked_at;
+static int overflow = -1;
+
+/* Called on every basic block of the instrumented game sources */
+void __sanitizer_cov_trace_pc(void)
+{
+    ++blocks;
+}
+
+static void finish(void)
+{
+    printf("worst_blocks %d %lu\n", worst_blocks_at, worst_blocks);
+    printf("worst_vram %d %lu\n", worst_vram_at, worst_vram);
+    printf("worst_unchecked %d %lu\n", worst_unchecked_at, worst_unchecked);
+    printf("overflow %d\n", overflow);
+    exit(0);
+}
+
+/* The active player's HUD digit tiles for its current values, in
+ * hud_shadow order */
+static void hud_digits(unsigned char *out)
+{
+    static const unsigned char len[3] = { 6, 4, 2 };
+    unsigned char r, c, d, *bcd[3];
+
+    bcd[0] = pl->score;
+    bcd[1] = pl->lines;
+    bcd[2] = &pl->level_bcd;
+    d = 0;
+    for (r = 0; r < 3; ++r)
+        for (c = 0; c < len[r]; ++c)
+            out[d++] = CHR('0') + ((c & 1) ? (bcd[r][c >> 1] & 0x0F) : (bcd[r][c >> 1] >> 4));
+}
+
+/* Load the scenario into the players, with the HUD shadow matching the
+ * loaded values so nothing is redrawn just because of the load */
+static void load_scenario(void)
+{
+    unsigned char n, r, c;
+
+    rng_seed = scn_seed;
+    for (n = 0; n < num_players; ++n) {
+        player_select(n);
+        pl->level = scn[n].level;
+        pl->level_bcd = (unsigned char)(((scn[n].level / 10) << 4) | (scn[n].level % 10));
+        memcpy(pl->score, scn[n].score, 3);
+        memcpy(pl->lines, scn[n].lines, 2);
+        pl->cur_piece = scn[n].piece;
+        pl->next_piece = scn[n].next;
+        pl->cur_rot = 0;
+        pl->cur_x = SPAWN_X;
+        pl->cur_y = -1;
+        for (r = 0; r < PF_H; ++r)
+            for (c = 0; c < PF_W; ++c)
+                playfield[row_ofs[r] + c] = scn[n].rows[r][c] == '.' ? 0 : CELL_GARBAGE;
+
+        hud_digits(pl->hud_shadow);
+        pl->hud_dirty = 0;
+
+        /* A piece that could not have spawned makes no real frame */
+        if (COLLIDES(pl->cur_piece, 0, SPAWN_X, -1)) {
+            printf("invalid\n");
+            exit(0);
+        }
+    }
+}
+
+/* VRAM entries the active player still has pending after this frame: an
+ * upper bound for the flash attributes, as cleared lines can share a
+ * quadrant row */
+static unsigned int pending(void)
+{
+    unsigned char digits[HUD_DIGITS], d, q;
+    unsigned int n;
+
+    n = (unsigned int)(pl->redraw_end - pl->redraw_row) * PF_W;
+    if (pl->state == STATE_LINECLEAR) {
+        n += (unsigned int)(pl->num_lines_clearing - pl->flash_row) * PF_W;
+        n += (unsigned int)(pl->num_lines_clearing - pl->flash_attr) * ATTR_ROW_BYTES;
+    }
+    /* Quadrant rows still to go back to palette 0 */
+    if (pl->state != STATE_LINECLEAR || !pl->flash_attr)
+        for (q = 0; q < 15; ++q)
+            if (pl->flash_qrows & (1u << q))
+                n += ATTR_ROW_BYTES;
+    hud_digits(digits);
+    for (d = 0; d < HUD_DIGITS; ++d)
+        if (digits[d] != pl->hud_shadow[d])
+            ++n;
+    return n;
+}
+
+/* The NMI's work for this frame, in VRAM queue entries */
+static unsigned int nmi_cost(void)
+{
+    return vbuf_len + (pal_dirty ? PAL_UPLOAD : 0);
+}
+
+/* ── Trace markers (the game sources are built with TRACE) ── */
+void trace_ev(unsigned char ev)
+{
+    player_t *p;
+    unsigned char n;
+
+    if (ev == EV_VRAM) {
+        /* Everything queued so far went in without a room check */
+        unchecked = nmi_cost();
+    } else if ((ev & EV_VBUF) && frame >= 0) {
+        p = pl;
+        backlog = 0;
+        for (n = 0; n < num_players; ++n) {
+            player_select(n);
+            backlog += pending();
+        }
+        pl = p;
+        playfield = playfields[pl->idx];
+    }
+}
+
+/* Fold a frame's VRAM counts into the worst cases; title frames are
+ * counted as frame -1 */
+static void note_vram(int at)
+{
+    if (nmi_cost() > vbuf_budget && overflow < 0)
+        overflow = at;
+    if (unchecked + backlog > worst_vram) {
+        worst_vram = unchecked + backlog;
+        worst_vram_at = at;
+    }
+    if (unchecked > worst_unchecked) {
+        worst_unchecked = unchecked;
+        worst_unchecked_at = at;
+    }
+}
+
+/* ── neslib stand-ins (the rest are host_neslib.c's) ── */
+void ppu_wait_nmi(void)
+{
+    if (frame >= 0) {
+        printf("frame %d %lu %u %u %u %u\n", frame, blocks, nmi_cost(), unchecked, backlog,
+               game_state);
+        if (blocks > worst_blocks) {
+            worst_blocks = blocks;
+            worst_blocks_at = frame;
+        }
+        note_vram(frame);
+        if (++frame == scn_frames)
+            finish();
+    } else if (game_state == STATE_PLAYING) {
+        load_scenario();
+        frame = 0;
+    } else {
+        if (game_state == STATE_TITLE) {
+            /* The title's label writes have no room check at all */
+            unchecked = nmi_cost();
+            note_vram(-1);
+        }
+        if (++setup_frame == SETUP_FRAMES) {
+            fprintf(stderr, "stress_host: game did not start\n");
+            exit(1);
+        }
+    }
+    vbuf_len = 0;
+    pal_dirty = 0;
+    blocks = 0;
+    unchecked = 0;
+    backlog = 0;
+}
+
+/* Palette calls only mark the upload the NMI will do */
+void pal_all(const unsigned char *data) { (void)data; pal_dirty = 1; }
+void pal_bg(const unsigned char *data) { (void)data; pal_dirty = 1; }
+void pal_spr(const unsigned char *data) { (void)data; pal_dirty = 1; }
+void pal_col(unsigned char index, unsigned char color) { (void)index; (void)color; pal_dirty = 1; }
+
+unsigned char pad_poll(unsigned char pad)
+{
+    if (frame >= 0)
+        return scn_pad[frame][pad];
+    if (pad)
+        return 0;
+    /* Title: both labels redrawn in one frame, the randomizer put back,
+     * SELECT again for one player, then START */
+    if (setup_frame == 1)
+        return PAD_SELECT | PAD_RIGHT;
+    if (setup_frame == 2)
+        return PAD_LEFT;
+    if (setup_frame == 3 && scn_players == 1)
+        return PAD_SELECT;
+    if (setup_frame == 4)
+        return PAD_START;
+    return 0;
+}
+
+/* ── Scenario parser ── */
+static void read_scenario(void)
+{
+    char line[256], row[64];
+    unsigned int a, b, c, d, e, f, g, h, i, p1, p2;
+    int n, r;
+
+    while (fgets(line, sizeof line, stdin)) {
+        if (sscanf(line, "region %u", &a) == 1) {
+            region = (unsigned char)a;
+        } else if (sscanf(line, "players %u", &a) == 1) {
+            scn_players = (unsigned char)(a > 1 ? 2 : 1);
+        } else if (sscanf(line, "rand %u", &a) == 1) {
+            scn_rand = (unsigned char)a;
+        } else if (sscanf(line, "seed %u", &a) == 1) {
+            scn_seed = a ? a : 1;
+        } else if (sscanf(line, "frames %d", &n) == 1) {
+            scn_frames = n < 1 ? 1 : n > MAX_FRAMES ? MAX_FRAMES : n;
+        } else if (sscanf(line, "player %d %u %x %x %x %x %x %u %u",
+                          &n, &a, &b, &c, &d, &e, &f, &g, &h) == 9 && n >= 0 && n < MAX_PLAYERS) {
+            scn[n].level = (unsigned char)(a > MAX_LEVEL ? MAX_LEVEL : a);
+            scn[n].score[0] = (unsigned char)b;
+            scn[n].score[1] = (unsigned char)c;
+            scn[n].score[2] = (unsigned char)d;
+            scn[n].lines[0] = (unsigned char)e;
+            scn[n].lines[1] = (unsigned char)f;
+            scn[n].piece = (unsigned char)(g % NUM_PIECES);
+            scn[n].next = (unsigned char)(h % NUM_PIECES);
+        } else if (sscanf(line, "row %d %d %63s", &n, &r, row) == 3
+                   && n >= 0 && n < MAX_PLAYERS && r >= 0 && r < PF_H) {
+            i = (unsigned int)strlen(row);
+            memset(scn[n].rows[r], '.', PF_W);
+            memcpy(scn[n].rows[r], row, i < PF_W ? i : PF_W);
+        } else if (sscanf(line, "pad %d %x %x", &n, &p1, &p2) == 3 && n >= 0 && n < MAX_FRAMES) {
+            scn_pad[n][0] = (unsigned char)p1;
+            scn_pad[n][1] = (unsigned char)p2;
+        }
+    }
+}
+
+int main(void)
+{
+    static const unsigned char budgets[] = { 42, 84, 42 };
+    int n, r;
+
+    for (n = 0; n < MAX_PLAYERS; ++n)
+        for (r = 0; r < PF_H; ++r)
+            memset(scn[n].rows[r], '.', PF_W);
+
+    read_scenario();
+    vbuf_budget = budgets[region % 3];
+    setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+
+    rand_mode = scn_rand;
+    game_main();
+    return 0;
+}
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""Generate tables.h: initializers for the lookup tables in src/tables.c,
+precomputed so the game core reads results instead of doing the math at
+runtime.
+
+Usage: tables_gen.py <output>
+"""
+
+import sys
+import os
+
+# Must match tetris.h
+MAX_LEVEL = 39
+# Points per line clear of 1-4 lines at level 0 (times level + 1)
+POINTS = [40, 100, 300, 1200]
+
+
+def bcd(value, nbytes):
+    """value as nbytes of packed BCD, most significant byte first."""
+    digits = f"{value:0{nbytes * 2}d}"
+    return [int(digits[i:i + 2], 16) for i in range(0, nbytes * 2, 2)]
+
+
+def generate_tables(output_path):
+    """Write tables.h."""
+    rows = []
+    for level in range(MAX_LEVEL + 1):
+        cells = ', '.join('{ ' + ', '.join(f"0x{b:02X}" for b in bcd(p * (level + 1), 3)) + ' }'
+                          for p in POINTS)
+        rows.append(f"    {{ {cells} }}, \\")
+
+    lines = [
+        "/* tables.h - Lookup table initializers for tables.c",
+        " * Generated by tools/tables_gen.py; do not edit.",
+        " */",
+        "",
+        "#ifndef _TABLES_H",
+        "#define _TABLES_H",
+        "",
+        "/* score_bcd[level][lines - 1]: points for a clear, 3 bytes BCD */",
+        "#define SCORE_BCD { \\",
+        *rows,
+        "}",
+        "",
+        "#endif /* _TABLES_H */",
+        "",
+    ]
+
+    os.makedirs(os.path.dirname(output_path) or '.', exist_ok=True)
+    with open(output_path, 'w') as f:
+        f.write('\n'.join(lines))
+
+    print(f"Generated {output_path}")
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    generate_tables(sys.argv[1])
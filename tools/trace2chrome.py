@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+"""Convert NESsy TRACE-build event markers into Chrome trace-event JSON.
+
+A TRACE build (make TRACE=1) writes one marker byte per event to $401F and
+to a ring in RAM: trace_buf for the main loop, trace_nmi_buf for the NMI.
+This tool reads either:
+
+  * an emulator trace log (FCEUX, Mesen, Nintendulator style text): every
+    "STA $401F" line is a marker, A is its value, and the CPU cycle is taken
+    from the line's cycle counter (or derived from scanline/dot), or
+  * a 2KB CPU RAM dump plus the ld65 label file (build/nessy.lbl) to locate
+    the rings. The NMI's entries are merged in after the main loop event
+    they followed. A dump has no timing, so events are spaced one unit
+    apart and only their order and the VRAM counts are meaningful.
+
+Output: open in chrome://tracing or https://ui.perfetto.dev. Each frame is
+a row (tid = frame number) and time is CPU cycles from the frame start
+(shown as microseconds). Frames longer than one video frame of the
+console's region (--region, default NTSC) are flagged.
+
+Usage:
+  trace2chrome.py trace.log -o trace.json
+  trace2chrome.py --ram ram.bin --labels build/nessy.lbl -o trace.json
+"""
+
+import argparse
+import json
+import re
+import sys
+
+# Marker bytes (must match the EV_* values in src/tetris.h)
+EV_FRAME = 0x01
+EV_VBUF = 0x80        # | queued entry count
+EV_IDLE = 0x09
+EV_NMI_IN = 0x0A
+EV_NMI_OUT = 0x0B
+
+EVENT_NAMES = {
+    0x01: 'frame',
+    0x02: 'input',
+    0x03: 'gravity',
+    0x04: 'lock',
+    0x05: 'line check',
+    0x06: 'score',
+    0x07: 'vram step',
+    0x09: 'idle',
+    0x0A: 'nmi',
+    0x0B: 'nmi exit',
+    0x0C: 'line clear',
+}
+
+TRACE_PORT = '$401F'
+TRACE_LEN = 64        # src/neslib.h
+TRACE_NMI_LEN = 16    # src/neslib.s
+# CPU cycles per frame, scanlines per frame and PPU dots per CPU cycle
+REGIONS = {
+    'ntsc': (29780.5, 262, 3.0),
+    'pal': (33247.5, 312, 3.2),
+    'dendy': (35464.0, 312, 3.0),
+}
+DOTS_PER_LINE = 341
+CYCLES_PER_FRAME, LINES_PER_FRAME, DOTS_PER_CYCLE = REGIONS['ntsc']
+
+# Absolute CPU cycle counters used by common trace loggers
+CYCLE_PATTERNS = [
+    re.compile(r'\bc(\d+)\b'),                    # FCEUX "c123456"
+    re.compile(r'CPU ?Cycles?:\s*(\d+)', re.I),   # Mesen / custom
+    re.compile(r'CycleCount:\s*(\d+)', re.I),
+]
+SCANLINE_RE = re.compile(r'SL:\s*(-?\d+)')
+DOT_RE = re.compile(r'(?:CYC|PPU|DOT):\s*(\d+)', re.I)
+REG_RE = {r: re.compile(r'\b' + r + r':([0-9A-Fa-f]{2})') for r in 'AXY'}
+STORE_RE = re.compile(r'\bST([AXY])\s+\$401F\b', re.I)
+
+
+def read_emulator_trace(path):
+    """Return [(cycle, byte)] for every write to the trace port."""
+    events = []
+    prev_pos = None
+    dots_base = 0
+    with open(path, 'r', errors='replace') as f:
+        for line in f:
+            m = STORE_RE.search(line)
+            if not m:
+                continue
+            reg = REG_RE[m.group(1).upper()].search(line)
+            if not reg:
+                continue
+            value = int(reg.group(1), 16)
+
+            cycle = None
+            for pat in CYCLE_PATTERNS:
+                c = pat.search(line)
+                if c:
+                    cycle = float(c.group(1))
+                    break
+            if cycle is None:
+                sl = SCANLINE_RE.search(line)
+                dot = DOT_RE.search(line)
+                if not (sl and dot):
+                    sys.exit(f'{path}: no cycle counter or scanline/dot on line:\n{line}')
+                # Pre-render line (-1 or 261) starts the frame
+                pos = ((int(sl.group(1)) + 1) % LINES_PER_FRAME) * DOTS_PER_LINE + int(dot.group(1))
+                if prev_pos is not None and pos < prev_pos:
+                    dots_base += LINES_PER_FRAME * DOTS_PER_LINE
+                prev_pos = pos
+                cycle = (dots_base + pos) / DOTS_PER_CYCLE
+            events.append((cycle, value))
+    return events
+
+
+def read_labels(path):
+    """Parse an ld65 -Ln label file into {name: address}."""
+    labels = {}
+    with open(path) as f:
+        for line in f:
+            parts = line.split()
+            if len(parts) >= 3 and parts[0] == 'al':
+                labels[parts[2].lstrip('.')] = int(parts[1], 16)
+    return labels
+
+
+def read_ram_dump(path, labels_path):
+    """Return [(ordinal, byte)] from the trace rings, oldest first."""
+    labels = read_labels(labels_path)
+    try:
+        adr = {name: labels['_' + name] for name in
+               ('trace_buf', 'trace_pos', 'trace_nmi_buf', 'trace_nmi_at', 'trace_nmi_pos')}
+    except KeyError as e:
+        sys.exit(f'{labels_path}: label {e} not found (is this a TRACE=1 build?)')
+    with open(path, 'rb') as f:
+        ram = f.read()
+    pos = ram[adr['trace_pos']]
+    ring = ram[adr['trace_buf']:adr['trace_buf'] + TRACE_LEN]
+    main = list(ring[pos:] + ring[:pos])
+
+    # NMI entries, newest first, with how many main events in the dump
+    # came after them. Consecutive NMIs are far fewer than TRACE_LEN main
+    # events apart, so the distances add up past trace_pos wrapping. Stop
+    # at a slot never written (0 is no marker) or one older than the
+    # main ring.
+    nmi_pos = ram[adr['trace_nmi_pos']]
+    nmi = []
+    at = pos
+    dist = 0
+    for k in range(1, TRACE_NMI_LEN + 1):
+        i = (nmi_pos - k) % TRACE_NMI_LEN
+        value = ram[adr['trace_nmi_buf'] + i]
+        dist += (at - ram[adr['trace_nmi_at'] + i]) % TRACE_LEN
+        at = ram[adr['trace_nmi_at'] + i]
+        if not value or dist > TRACE_LEN:
+            break
+        nmi.append((TRACE_LEN - dist, value))
+    nmi.reverse()
+
+    ordered = []
+    for n, b in enumerate([None] + main):
+        if b is not None:
+            ordered.append(b)
+        while nmi and nmi[0][0] == n:
+            ordered.append(nmi.pop(0)[1])
+    return [(float(i), b) for i, b in enumerate(ordered)]
+
+
+def build_trace(events, timed):
+    """Group markers into frames and emit Chrome trace events."""
+    out = []
+    frame = -1
+    frame_start = None
+    open_slice = None     # (name, start) of the running main-loop slice
+    nmi_start = None
+    frames = []
+
+    def close_slice(now):
+        nonlocal open_slice
+        if open_slice and frame >= 0:
+            name, start = open_slice
+            out.append({'name': name, 'ph': 'X', 'pid': 0, 'tid': frame,
+                        'ts': start - frame_start, 'dur': max(now - start, 0)})
+        open_slice = None
+
+    for ts, value in events:
+        if value & EV_VBUF:
+            if frame >= 0:
+                out.append({'name': 'vbuf', 'ph': 'i', 's': 't', 'pid': 0, 'tid': frame,
+                            'ts': ts - frame_start, 'args': {'entries': value & ~EV_VBUF}})
+        elif value == EV_FRAME:
+            close_slice(ts)
+            if frame >= 0:
+                frames.append((frame, frame_start, ts))
+            frame += 1
+            frame_start = ts
+            open_slice = ('frame start', ts)
+        elif value == EV_NMI_IN:
+            nmi_start = ts
+        elif value == EV_NMI_OUT:
+            if nmi_start is not None and frame >= 0:
+                out.append({'name': 'nmi', 'ph': 'X', 'pid': 0, 'tid': frame,
+                            'ts': nmi_start - frame_start, 'dur': ts - nmi_start})
+            nmi_start = None
+        else:
+            close_slice(ts)
+            open_slice = (EVENT_NAMES.get(value, f'event {value:#04x}'), ts)
+
+    for n, start, end in frames:
+        dur = end - start
+        args = {'cycles': dur}
+        if timed and dur > CYCLES_PER_FRAME + 1:
+            args['lag'] = True
+        out.append({'name': 'LAG frame' if args.get('lag') else 'frame', 'ph': 'X',
+                    'pid': 1, 'tid': n, 'ts': 0, 'dur': dur, 'args': args})
+        out.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': n,
+                    'args': {'name': f'frame {n}'}})
+
+    meta = [
+        {'name': 'process_name', 'ph': 'M', 'pid': 0,
+         'args': {'name': 'events (time = CPU cycles)' if timed else 'events (time = event order)'}},
+        {'name': 'process_name', 'ph': 'M', 'pid': 1, 'args': {'name': 'frame totals'}},
+    ]
+    return {'traceEvents': meta + out, 'displayTimeUnit': 'ms'}, frames
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    ap.add_argument('trace', nargs='?', help='emulator trace log')
+    ap.add_argument('--ram', help='2KB CPU RAM dump instead of a trace log')
+    ap.add_argument('--labels', default='build/nessy.lbl', help='ld65 -Ln label file (with --ram)')
+    ap.add_argument('--region', choices=sorted(REGIONS), default='ntsc',
+                    help='console region, for frame length and lag flagging')
+    ap.add_argument('-o', '--output', default='trace.json')
+    args = ap.parse_args()
+
+    global CYCLES_PER_FRAME, LINES_PER_FRAME, DOTS_PER_CYCLE
+    CYCLES_PER_FRAME, LINES_PER_FRAME, DOTS_PER_CYCLE = REGIONS[args.region]
+
+    if args.ram:
+        events = read_ram_dump(args.ram, args.labels)
+        timed = False
+    elif args.trace:
+        events = read_emulator_trace(args.trace)
+        timed = True
+    else:
+        ap.error('give an emulator trace log or --ram')
+
+    if not events:
+        sys.exit(f'No writes to {TRACE_PORT} found (is this a TRACE=1 build?)')
+
+    trace, frames = build_trace(events, timed)
+    with open(args.output, 'w') as f:
+        json.dump(trace, f)
+
+    lag = sum(1 for _, s, e in frames if timed and e - s > CYCLES_PER_FRAME + 1)
+    print(f"Wrote {args.output} ({len(events)} markers, {len(frames)} frames"
+          + (f", {lag} lag frames)" if timed else ")"))
+
+
+if __name__ == '__main__':
+    main()